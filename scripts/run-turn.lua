@@ -163,8 +163,10 @@ function process(rules, orders)
     write_files(config.locales)
     dbupdate()
 
+    -- the reports and the database update change factions, so the
+    -- snapshot for the datafile can only be taken after them
     file = '' .. get_turn() .. '.dat'
-    if eressea.write_game(file)~=0 then
+    if eressea.write_game_async(file)~=0 or eressea.wait_game()~=0 then
         eressea.log.error("could not write game")
         return -1
     end
@@ -8,6 +8,7 @@ module("tests.bindings", lunit.testcase)
 function test_eressea()
 	assert_equal("function", _G.type(eressea.free_game))
 	assert_equal("function", _G.type(eressea.read_game))
+	assert_equal("function", _G.type(eressea.read_game_area))
 	assert_equal("function", _G.type(eressea.write_game))
 	assert_equal("function", _G.type(eressea.read_orders))
 end
@@ -0,0 +1,5 @@
+-- export the game state of a turn as column files for analysis:
+-- eressea -t <turn> scripts/tools/columns.lua
+read_xml()
+eressea.read_game(get_turn() .. '.dat')
+eressea.export_columns('columns-' .. get_turn())
@@ -0,0 +1,7 @@
+-- check the datafile for a turn without loading it, and print the
+-- size of its sections: eressea -t <turn> scripts/tools/verify.lua
+read_xml()
+local errors = eressea.verify_game(get_turn() .. '.dat')
+if errors ~= 0 then
+    os.exit(1)
+end
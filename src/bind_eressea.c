@@ -2,6 +2,7 @@
 
 #include <platform.h>
 
+#include "columns.h"
 #include "json.h"
 #include "orderfile.h"
 
@@ -26,11 +27,27 @@ int eressea_read_game(const char * filename) {
     return readgame(filename);
 }
 
+int eressea_read_game_area(const char * filename, int left, int bottom, int right, int top) {
+    return readgame_area(filename, left, bottom, right, top);
+}
+
 int eressea_write_game(const char * filename) {
     remove_empty_factions();
     return writegame(filename);
 }
 
+int eressea_write_game_async(const char * filename) {
+    return writegame_async(filename, remove_empty_factions);
+}
+
+int eressea_wait_game(void) {
+    return writegame_wait();
+}
+
+int eressea_verify_game(const char * filename) {
+    return verify_game(filename, stdout);
+}
+
 int eressea_read_orders(const char * filename) {
     return readorders(filename);
 }
@@ -62,3 +79,7 @@ int eressea_import_json(const char * filename) {
     perror(filename);
     return -1;
 }
+
+int eressea_export_columns(const char * path) {
+    return columns_export(path);
+}
@@ -6,11 +6,16 @@ extern "C" {
 
 void eressea_free_game(void);
 int eressea_read_game(const char * filename);
+int eressea_read_game_area(const char * filename, int left, int bottom, int right, int top);
 int eressea_write_game(const char * filename);
+int eressea_write_game_async(const char * filename);
+int eressea_wait_game(void);
+int eressea_verify_game(const char * filename);
 int eressea_read_orders(const char * filename);
 
 int eressea_export_json(const char * filename, int flags);
 int eressea_import_json(const char * filename);
+int eressea_export_columns(const char * path);
 #ifdef __cplusplus
 }
 #endif
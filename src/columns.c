@@ -0,0 +1,240 @@
+#include <platform.h>
+
+#include "columns.h"
+#include "skill.h"
+
+#include <kernel/building.h>
+#include <kernel/config.h>
+#include <kernel/faction.h>
+#include <kernel/item.h>
+#include <kernel/race.h>
+#include <kernel/region.h>
+#include <kernel/ship.h>
+#include <kernel/skills.h>
+#include <kernel/terrain.h>
+#include <kernel/unit.h>
+
+#include <util/log.h>
+
+#include <sys/stat.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAXCOLUMNS 8
+
+/* the suffix of a column is the format of its file: .i32 for 32-bit
+ * integers in native byte order, .str for NUL-terminated strings. */
+typedef struct table {
+    const char *name;
+    const char *columns[MAXCOLUMNS];
+    FILE *files[MAXCOLUMNS];
+    int rows;
+    int error; /* errno of the first write that failed */
+} table;
+
+enum {
+    T_REGIONS,
+    T_BUILDINGS,
+    T_UNITS,
+    T_ITEMS,
+    T_SKILLS,
+    MAXTABLES
+};
+
+static const table schema[MAXTABLES] = {
+    { "regions", { "uid.i32", "x.i32", "y.i32", "terrain.str",
+        "peasants.i32", "money.i32", "trees.i32", "horses.i32" } },
+    { "buildings", { "no.i32", "region.i32", "type.str", "size.i32" } },
+    { "units", { "no.i32", "faction.i32", "region.i32", "race.str",
+        "number.i32", "hp.i32", "building.i32", "ship.i32" } },
+    { "items", { "unit.i32", "type.str", "number.i32" } },
+    { "skills", { "unit.i32", "skill.str", "level.i32", "weeks.i32" } }
+};
+
+static void write_error(table *t)
+{
+    if (!t->error) {
+        t->error = errno ? errno : EIO;
+    }
+}
+
+static void put_int(table *t, int col, int value)
+{
+    assert(strstr(t->columns[col], ".i32"));
+    if (fwrite(&value, sizeof(int), 1, t->files[col]) != 1) {
+        write_error(t);
+    }
+}
+
+static void put_str(table *t, int col, const char *value)
+{
+    size_t len = strlen(value) + 1;
+    assert(strstr(t->columns[col], ".str"));
+    if (fwrite(value, 1, len, t->files[col]) != len) {
+        write_error(t);
+    }
+}
+
+/* returns the first error of any table, or 0 */
+static int close_tables(table *tables)
+{
+    int i, c, err = 0;
+    for (i = 0; i != MAXTABLES; ++i) {
+        for (c = 0; c != MAXCOLUMNS && tables[i].columns[c]; ++c) {
+            if (tables[i].files[c]) {
+                if (fclose(tables[i].files[c]) != 0) {
+                    write_error(tables + i);
+                }
+                tables[i].files[c] = NULL;
+            }
+        }
+        if (!err) {
+            err = tables[i].error;
+        }
+    }
+    return err;
+}
+
+static int open_tables(table *tables, const char *path)
+{
+    char filename[64], buffer[MAX_PATH];
+    int i, c;
+
+    memcpy(tables, schema, sizeof(schema));
+    for (i = 0; i != MAXTABLES; ++i) {
+        for (c = 0; c != MAXCOLUMNS && tables[i].columns[c]; ++c) {
+            snprintf(filename, sizeof(filename), "%s.%s", tables[i].name, tables[i].columns[c]);
+            tables[i].files[c] = fopen(join_path(path, filename, buffer, sizeof(buffer)), "wb");
+            if (!tables[i].files[c]) {
+                int err = errno;
+                perror(buffer);
+                close_tables(tables);
+                return err;
+            }
+        }
+    }
+    return 0;
+}
+
+static int write_schema(const table *tables, const char *path)
+{
+    char buffer[MAX_PATH];
+    FILE *F;
+    int i, c, err;
+
+    F = fopen(join_path(path, "columns.txt", buffer, sizeof(buffer)), "wt");
+    if (!F) {
+        perror(buffer);
+        return errno;
+    }
+    for (i = 0; i != MAXTABLES; ++i) {
+        fprintf(F, "%s %d", tables[i].name, tables[i].rows);
+        for (c = 0; c != MAXCOLUMNS && tables[i].columns[c]; ++c) {
+            fprintf(F, " %s", tables[i].columns[c]);
+        }
+        fputc('\n', F);
+    }
+    err = ferror(F);
+    if (fclose(F) != 0 || err) {
+        err = errno ? errno : EIO;
+        perror(buffer);
+        return err;
+    }
+    return 0;
+}
+
+static void export_unit(table *tables, const unit *u)
+{
+    table *t = tables + T_UNITS;
+    const item *itm;
+    int i;
+
+    put_int(t, 0, u->no);
+    put_int(t, 1, u->faction ? u->faction->no : 0);
+    put_int(t, 2, u->region ? u->region->uid : 0);
+    put_str(t, 3, u_race(u)->_name);
+    put_int(t, 4, u->number);
+    put_int(t, 5, u->hp);
+    put_int(t, 6, u->building ? u->building->no : 0);
+    put_int(t, 7, u->ship ? u->ship->no : 0);
+    ++t->rows;
+
+    t = tables + T_ITEMS;
+    for (itm = u->items; itm; itm = itm->next) {
+        put_int(t, 0, u->no);
+        put_str(t, 1, itm->type->rtype->_name);
+        put_int(t, 2, itm->number);
+        ++t->rows;
+    }
+
+    t = tables + T_SKILLS;
+    for (i = 0; i != u->skill_size; ++i) {
+        const skill *sv = u->skills + i;
+        put_int(t, 0, u->no);
+        put_str(t, 1, skillnames[sv->id]);
+        put_int(t, 2, sv->level);
+        put_int(t, 3, sv->weeks);
+        ++t->rows;
+    }
+}
+
+static void export_region(table *tables, const region *r)
+{
+    table *t = tables + T_REGIONS;
+    const building *b;
+    const unit *u;
+
+    put_int(t, 0, r->uid);
+    put_int(t, 1, r->x);
+    put_int(t, 2, r->y);
+    put_str(t, 3, r->terrain->_name);
+    put_int(t, 4, rpeasants(r));
+    put_int(t, 5, rmoney(r));
+    put_int(t, 6, rtrees(r, 2));
+    put_int(t, 7, rhorses(r));
+    ++t->rows;
+
+    t = tables + T_BUILDINGS;
+    for (b = r->buildings; b; b = b->next) {
+        put_int(t, 0, b->no);
+        put_int(t, 1, r->uid);
+        put_str(t, 2, b->type->_name);
+        put_int(t, 3, b->size);
+        ++t->rows;
+    }
+
+    for (u = r->units; u; u = u->next) {
+        export_unit(tables, u);
+    }
+}
+
+int columns_export(const char *path)
+{
+    table tables[MAXTABLES];
+    const region *r;
+    int err;
+
+    if (mkdir(path, 0777) != 0 && errno != EEXIST) {
+        perror(path);
+        return errno;
+    }
+    errno = 0;
+    err = open_tables(tables, path);
+    if (err) {
+        return err;
+    }
+    for (r = regions; r; r = r->next) {
+        export_region(tables, r);
+    }
+    err = close_tables(tables);
+    if (err) {
+        log_error("could not export to %s: %s", path, strerror(err));
+        return err;
+    }
+    log_debug("exported %d regions and %d units to %s",
+        tables[T_REGIONS].rows, tables[T_UNITS].rows, path);
+    return write_schema(tables, path);
+}
@@ -0,0 +1,10 @@
+#pragma once
+#ifndef ERESSEA_COLUMNS_H
+#define ERESSEA_COLUMNS_H
+
+/* write regions, buildings, units, items and skills to one file per
+ * column in the directory path, and a list of the tables with their
+ * row count and columns to columns.txt */
+int columns_export(const char *path);
+
+#endif
@@ -0,0 +1,91 @@
+#include <platform.h>
+#include "columns.h"
+#include "tests.h"
+
+#include <kernel/config.h>
+#include <kernel/faction.h>
+#include <kernel/item.h>
+#include <kernel/region.h>
+#include <kernel/unit.h>
+
+#include <CuTest.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static FILE *open_column(const char *path, const char *name) {
+    char buffer[MAX_PATH];
+    return fopen(join_path(path, name, buffer, sizeof(buffer)), "rb");
+}
+
+static void remove_columns(const char *path) {
+    char line[256], buffer[MAX_PATH];
+    FILE *F = open_column(path, "columns.txt");
+
+    while (fgets(line, sizeof(line), F)) {
+        char name[64];
+        const char *tbl = strtok(line, " \n");
+        const char *col;
+        strtok(NULL, " \n");
+        while ((col = strtok(NULL, " \n")) != NULL) {
+            snprintf(name, sizeof(name), "%s.%s", tbl, col);
+            remove(join_path(path, name, buffer, sizeof(buffer)));
+        }
+    }
+    fclose(F);
+    remove(join_path(path, "columns.txt", buffer, sizeof(buffer)));
+    remove(path);
+}
+
+static void test_columns_export(CuTest *tc) {
+    const char *path = "columns.test";
+    char line[256];
+    unit *u;
+    FILE *F;
+    int values[2];
+
+    test_setup();
+    test_create_region(1, 2, NULL);
+    u = test_create_unit(test_create_faction(NULL), test_create_region(0, 0, NULL));
+    scale_number(u, 3);
+    i_change(&u->items, test_create_itemtype("iron"), 5);
+    set_level(u, SK_MINING, 2);
+    CuAssertIntEquals(tc, 0, columns_export(path));
+
+    F = open_column(path, "columns.txt");
+    CuAssertPtrNotNull(tc, F);
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertStrEquals(tc, "regions 2 uid.i32 x.i32 y.i32 terrain.str peasants.i32 money.i32 trees.i32 horses.i32\n", line);
+    fclose(F);
+
+    F = open_column(path, "regions.x.i32");
+    CuAssertIntEquals(tc, 2, (int)fread(values, sizeof(int), 2, F));
+    CuAssertIntEquals(tc, 1, values[0]);
+    CuAssertIntEquals(tc, 0, values[1]);
+    fclose(F);
+
+    F = open_column(path, "units.number.i32");
+    CuAssertIntEquals(tc, 1, (int)fread(values, sizeof(int), 2, F));
+    CuAssertIntEquals(tc, 3, values[0]);
+    fclose(F);
+
+    F = open_column(path, "items.type.str");
+    CuAssertIntEquals(tc, 5, (int)fread(line, 1, sizeof(line), F));
+    CuAssertStrEquals(tc, "iron", line);
+    fclose(F);
+
+    F = open_column(path, "skills.level.i32");
+    CuAssertIntEquals(tc, 1, (int)fread(values, sizeof(int), 2, F));
+    CuAssertIntEquals(tc, 2, values[0]);
+    fclose(F);
+
+    remove_columns(path);
+    test_cleanup();
+}
+
+CuSuite *get_columns_suite(void)
+{
+    CuSuite *suite = CuSuiteNew();
+    SUITE_ADD_TEST(suite, test_columns_export);
+    return suite;
+}
@@ -139,14 +139,14 @@ static const char *translate(const char *key, const char *value)
     return crtag(key);
 }
 
-static void report_translations(FILE * F)
+static void report_translations(struct stream *out)
 {
     int i;
-    fputs("TRANSLATION\n", F);
+    sputs("TRANSLATION", out);
     for (i = 0; i != TRANSMAXHASH; ++i) {
         translation *t = translation_table[i];
         while (t) {
-            fprintf(F, "\"%s\";%s\n", t->value, crtag(t->key));
+            stream_printf(out, "\"%s\";%s\n", t->value, crtag(t->key));
             t = t->next;
         }
     }
@@ -170,7 +170,7 @@ static void reset_translations(void)
 
 #include <kernel/objtypes.h>
 
-static void print_items(FILE * F, item * items, const struct locale *lang)
+static void print_items(struct stream *out, item * items, const struct locale *lang)
 {
     item *itm;
 
@@ -178,8 +178,8 @@ static void print_items(FILE * F, item * items, const struct locale *lang)
         int in = itm->number;
         const char *ic = resourcename(itm->type->rtype, 0);
         if (itm == items)
-            fputs("GEGENSTAENDE\n", F);
-        fprintf(F, "%d;%s\n", in, translate(ic, LOC(lang, ic)));
+            sputs("GEGENSTAENDE", out);
+        stream_printf(out, "%d;%s\n", in, translate(ic, LOC(lang, ic)));
     }
 }
 
@@ -291,13 +291,6 @@ cr_output_curses(struct stream *out, const faction * viewer, const void *obj, ob
     }
 }
 
-static void cr_output_curses_compat(FILE *F, const faction * viewer, const void *obj, objtype_t typ) {
-    /* TODO: eliminate this function */
-    stream strm;
-    fstream_init(&strm, F);
-    cr_output_curses(&strm, viewer, obj, typ);
-}
-
 static int cr_unit(variant var, char *buffer, const void *userdata)
 {
     unit *u = (unit *)var.v;
@@ -503,7 +496,7 @@ static struct known_mtype {
     struct known_mtype *nexthash;
 } *mtypehash[MTMAXHASH];
 
-static void report_crtypes(FILE * F, const struct locale *lang)
+static void report_crtypes(struct stream *out, const struct locale *lang)
 {
     int i;
     for (i = 0; i != MTMAXHASH; ++i) {
@@ -514,11 +507,9 @@ static void report_crtypes(FILE * F, const struct locale *lang)
                 char buffer[DISPLAYSIZE];
                 unsigned int hash = kmt->mtype->key;
                 assert(hash > 0);
-                fprintf(F, "MESSAGETYPE %u\n", hash);
-                fputc('\"', F);
-                fputs(escape_string(nrt_string(nrt), buffer, sizeof(buffer)), F);
-                fputs("\";text\n", F);
-                fprintf(F, "\"%s\";section\n", nrt_section(nrt));
+                stream_printf(out, "MESSAGETYPE %u\n", hash);
+                stream_printf(out, "\"%s\";text\n", escape_string(nrt_string(nrt), buffer, sizeof(buffer)));
+                stream_printf(out, "\"%s\";section\n", nrt_section(nrt));
             }
         }
         while (mtypehash[i]) {
@@ -536,38 +527,34 @@ static unsigned int messagehash(const struct message *msg)
     return (unsigned int)var.i;
 }
 
-/** writes a quoted string to the file
+/** writes a quoted string to the stream
 * no trailing space, since this is used to make the creport.
+* text between the characters that need escaping is written in one piece.
 */
-static int fwritestr(FILE * F, const char *str)
+int swritestr(struct stream *out, const char *str)
 {
-    int nwrite = 0;
-    fputc('\"', F);
-    if (str)
+    int nwrite = 2;
+    swrite("\"", 1, 1, out);
+    if (str) {
         while (*str) {
-            int c = (int)(unsigned char)*str++;
-            switch (c) {
-            case '"':
-            case '\\':
-                fputc('\\', F);
-                fputc(c, F);
-                nwrite += 2;
-                break;
-            case '\n':
-                fputc('\\', F);
-                fputc('n', F);
+            size_t len = strcspn(str, "\"\\\n");
+            if (len) {
+                swrite(str, 1, len, out);
+                nwrite += (int)len;
+                str += len;
+            }
+            if (*str) {
+                swrite(*str == '\n' ? "\\n" : (*str == '"' ? "\\\"" : "\\\\"), 1, 2, out);
                 nwrite += 2;
-                break;
-            default:
-                fputc(c, F);
-                ++nwrite;
+                ++str;
             }
         }
-    fputc('\"', F);
-    return nwrite + 2;
+    }
+    swrite("\"", 1, 1, out);
+    return nwrite;
 }
 
-static void render_messages(FILE * F, faction * f, message_list * msgs)
+static void render_messages(struct stream *out, faction * f, message_list * msgs)
 {
     struct mlist *m = msgs->begin;
     while (m) {
@@ -578,11 +565,11 @@ static void render_messages(FILE * F, faction * f, message_list * msgs)
 #ifdef RENDER_CRMESSAGES
         char nrbuffer[1024 * 32];
         nrbuffer[0] = '\0';
-        if (nr_render(m->msg, f->locale, nrbuffer, sizeof(nrbuffer), f) > 0) {
-            fprintf(F, "MESSAGE %u\n", messagehash(m->msg));
-            fprintf(F, "%u;type\n", hash);
-            fwritestr(F, nrbuffer);
-            fputs(";rendered\n", F);
+        if (render_message(m->msg, f, nrbuffer, sizeof(nrbuffer)) > 0) {
+            stream_printf(out, "MESSAGE %u\n", messagehash(m->msg));
+            stream_printf(out, "%u;type\n", hash);
+            swritestr(out, nrbuffer);
+            sputs(";rendered", out);
             printed = true;
         }
 #endif
@@ -590,9 +577,9 @@ static void render_messages(FILE * F, faction * f, message_list * msgs)
         if (cr_render(m->msg, crbuffer, (const void *)f) == 0) {
             if (crbuffer[0]) {
                 if (!printed) {
-                    fprintf(F, "MESSAGE %u\n", messagehash(m->msg));
+                    stream_printf(out, "MESSAGE %u\n", messagehash(m->msg));
                 }
-                fputs(crbuffer, F);
+                swrite(crbuffer, 1, strlen(crbuffer), out);
             }
         }
         else {
@@ -614,10 +601,10 @@ static void render_messages(FILE * F, faction * f, message_list * msgs)
     }
 }
 
-static void cr_output_messages(FILE * F, message_list * msgs, faction * f)
+static void cr_output_messages(struct stream *out, message_list * msgs, faction * f)
 {
     if (msgs)
-        render_messages(F, f, msgs);
+        render_messages(out, f, msgs);
 }
 
 /* prints a building */
@@ -659,15 +646,6 @@ static void cr_output_building(struct stream *out, building *b,
     cr_output_curses(out, f, b, TYP_BUILDING);
 }
 
-static void cr_output_building_compat(FILE *F, building *b,
-    const unit *owner, int fno, faction *f)
-{
-    /* TODO: eliminate this function */
-    stream strm;
-    fstream_init(&strm, F);
-    cr_output_building(&strm, b, owner, fno, f);
-}
-
 /* = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =  */
 
 /* prints a ship */
@@ -714,15 +692,6 @@ static void cr_output_ship(struct stream *out, const ship *sh, const unit *u,
     cr_output_curses(out, f, sh, TYP_SHIP);
 }
 
-static void cr_output_ship_compat(FILE *F, const ship *sh, const unit *u,
-    int fcaptain, const faction *f, const region *r)
-{
-    /* TODO: eliminate this function */
-    stream strm;
-    fstream_init(&strm, F);
-    cr_output_ship(&strm, sh, u, fcaptain, f, r);
-}
-
 static int stream_order(stream *out, const struct order *ord, const struct locale *lang) {
     const char *str;
     char ebuf[1025];
@@ -1004,63 +973,54 @@ void cr_output_unit(stream *out, const region * r, const faction * f,
     cr_output_curses(out, f, u, TYP_UNIT);
 }
 
-static void cr_output_unit_compat(FILE * F, const region * r, const faction * f,
-    const unit * u, int mode)
-{
-    /* TODO: eliminate this function */
-    stream strm;
-    fstream_init(&strm, F);
-    cr_output_unit(&strm, r, f, u, mode);
-}
-
 /* = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =  */
 
 /* prints allies */
-static void show_allies_cr(FILE * F, const faction * f, const ally * sf)
+static void show_allies_cr(struct stream *out, const faction * f, const ally * sf)
 {
     for (; sf; sf = sf->next)
         if (sf->faction) {
             int mode = alliedgroup(NULL, f, sf->faction, sf, HELP_ALL);
             if (mode != 0 && sf->status > 0) {
-                fprintf(F, "ALLIANZ %d\n", sf->faction->no);
-                fprintf(F, "\"%s\";Parteiname\n", sf->faction->name);
-                fprintf(F, "%d;Status\n", sf->status & HELP_ALL);
+                stream_printf(out, "ALLIANZ %d\n", sf->faction->no);
+                stream_printf(out, "\"%s\";Parteiname\n", sf->faction->name);
+                stream_printf(out, "%d;Status\n", sf->status & HELP_ALL);
             }
         }
 }
 
 /* prints allies */
-static void show_alliances_cr(FILE * F, const faction * f)
+static void show_alliances_cr(struct stream *out, const faction * f)
 {
     alliance *al = f_get_alliance(f);
     if (al) {
         faction *lead = alliance_get_leader(al);
         assert(lead);
-        fprintf(F, "ALLIANCE %d\n", al->id);
-        fprintf(F, "\"%s\";name\n", al->name);
-        fprintf(F, "%d;leader\n", lead->no);
+        stream_printf(out, "ALLIANCE %d\n", al->id);
+        stream_printf(out, "\"%s\";name\n", al->name);
+        stream_printf(out, "%d;leader\n", lead->no);
     }
 }
 
 /* = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =  */
 
 /* this is a copy of laws.c->find_address output changed. */
-static void cr_find_address(FILE * F, const faction * uf, selist * addresses)
+static void cr_find_address(struct stream *out, const faction * uf, selist * addresses)
 {
     int i = 0;
     selist *flist = addresses;
     while (flist) {
         const faction *f = (const faction *)selist_get(flist, i);
         if (uf != f) {
-            fprintf(F, "PARTEI %d\n", f->no);
-            fprintf(F, "\"%s\";Parteiname\n", f->name);
+            stream_printf(out, "PARTEI %d\n", f->no);
+            stream_printf(out, "\"%s\";Parteiname\n", f->name);
             if (strcmp(faction_getemail(f), "") != 0)
-                fprintf(F, "\"%s\";email\n", faction_getemail(f));
+                stream_printf(out, "\"%s\";email\n", faction_getemail(f));
             if (f->banner)
-                fprintf(F, "\"%s\";banner\n", f->banner);
-            fprintf(F, "\"%s\";locale\n", locale_name(f->locale));
+                stream_printf(out, "\"%s\";banner\n", f->banner);
+            stream_printf(out, "\"%s\";locale\n", locale_name(f->locale));
             if (f->alliance && f->alliance == uf->alliance) {
-                fprintf(F, "%d;alliance\n", f->alliance->id);
+                stream_printf(out, "%d;alliance\n", f->alliance->id);
             }
         }
         selist_advance(&flist, &i, 1);
@@ -1069,40 +1029,40 @@ static void cr_find_address(FILE * F, const faction * uf, selist * addresses)
 
 /* = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =  */
 
-static void cr_reportspell(FILE * F, spell * sp, int level, const struct locale *lang)
+static void cr_reportspell(struct stream *out, spell * sp, int level, const struct locale *lang)
 {
     int k;
     const char *name =
         translate(mkname("spell", sp->sname), spell_name(sp, lang));
 
-    fprintf(F, "ZAUBER %d\n", hashstring(sp->sname));
-    fprintf(F, "\"%s\";name\n", name);
-    fprintf(F, "%d;level\n", level);
-    fprintf(F, "%d;rank\n", sp->rank);
-    fprintf(F, "\"%s\";info\n", spell_info(sp, lang));
+    stream_printf(out, "ZAUBER %d\n", hashstring(sp->sname));
+    stream_printf(out, "\"%s\";name\n", name);
+    stream_printf(out, "%d;level\n", level);
+    stream_printf(out, "%d;rank\n", sp->rank);
+    stream_printf(out, "\"%s\";info\n", spell_info(sp, lang));
     if (sp->parameter)
-        fprintf(F, "\"%s\";syntax\n", sp->parameter);
+        stream_printf(out, "\"%s\";syntax\n", sp->parameter);
     else
-        fputs("\"\";syntax\n", F);
+        sputs("\"\";syntax", out);
 
     if (sp->sptyp & PRECOMBATSPELL)
-        fputs("\"precombat\";class\n", F);
+        sputs("\"precombat\";class", out);
     else if (sp->sptyp & COMBATSPELL)
-        fputs("\"combat\";class\n", F);
+        sputs("\"combat\";class", out);
     else if (sp->sptyp & POSTCOMBATSPELL)
-        fputs("\"postcombat\";class\n", F);
+        sputs("\"postcombat\";class", out);
     else
-        fputs("\"normal\";class\n", F);
+        sputs("\"normal\";class", out);
 
     if (sp->sptyp & FARCASTING)
-        fputs("1;far\n", F);
+        sputs("1;far", out);
     if (sp->sptyp & OCEANCASTABLE)
-        fputs("1;ocean\n", F);
+        sputs("1;ocean", out);
     if (sp->sptyp & ONSHIPCAST)
-        fputs("1;ship\n", F);
+        sputs("1;ship", out);
     if (!(sp->sptyp & NOTFAMILIARCAST))
-        fputs("1;familiar\n", F);
-    fputs("KOMPONENTEN\n", F);
+        sputs("1;familiar", out);
+    sputs("KOMPONENTEN", out);
 
     for (k = 0; sp->components[k].type; ++k) {
         const resource_type *rtype = sp->components[k].type;
@@ -1110,7 +1070,7 @@ static void cr_reportspell(FILE * F, spell * sp, int level, const struct locale
         int costtyp = sp->components[k].cost;
         if (itemanz > 0) {
             const char *name = resourcename(rtype, 0);
-            fprintf(F, "%d %d;%s\n", itemanz, costtyp == SPC_LEVEL
+            stream_printf(out, "%d %d;%s\n", itemanz, costtyp == SPC_LEVEL
                 || costtyp == SPC_LINEAR, translate(name, LOC(lang, name)));
         }
     }
@@ -1138,7 +1098,7 @@ static char *cr_output_resource(char *buf, const resource_type *rtype,
 }
 
 static void
-cr_borders(const region * r, const faction * f, seen_mode mode, FILE * F)
+cr_borders(const region * r, const faction * f, seen_mode mode, struct stream *out)
 {
     direction_t d;
     int g = 0;
@@ -1172,15 +1132,15 @@ cr_borders(const region * r, const faction * f, seen_mode mode, FILE * F)
             if (cs) {
                 const char *bname = border_name(b, r, f, GF_PURE);
                 bname = mkname("border", bname);
-                fprintf(F, "GRENZE %d\n", ++g);
-                fprintf(F, "\"%s\";typ\n", LOC(f->locale, bname));
-                fprintf(F, "%d;richtung\n", d);
+                stream_printf(out, "GRENZE %d\n", ++g);
+                stream_printf(out, "\"%s\";typ\n", LOC(f->locale, bname));
+                stream_printf(out, "%d;richtung\n", d);
                 if (!b->type->transparent(b, f))
-                    fputs("1;opaque\n", F);
+                    sputs("1;opaque", out);
                 /* hack: */
                 if (b->type == &bt_road && r->terrain->max_road) {
                     int p = rroad(r, d) * 100 / r->terrain->max_road;
-                    fprintf(F, "%d;prozent\n", p);
+                    stream_printf(out, "%d;prozent\n", p);
                 }
             }
             b = b->next;
@@ -1228,73 +1188,64 @@ void cr_output_resources(stream *out, const faction * f, const region *r, bool s
     }
 }
 
-static void cr_output_resources_compat(FILE *F, report_context * ctx,
-    region *r, bool see_unit)
-{
-    /* TODO: eliminate this function */
-    stream strm;
-    fstream_init(&strm, F);
-    cr_output_resources(&strm, ctx->f, r, see_unit);
-}
-
 
 static void
-cr_region_header(FILE * F, int plid, int nx, int ny, int uid)
+cr_region_header(struct stream *out, int plid, int nx, int ny, int uid)
 {
     if (plid == 0) {
-        fprintf(F, "REGION %d %d\n", nx, ny);
+        stream_printf(out, "REGION %d %d\n", nx, ny);
     }
     else {
-        fprintf(F, "REGION %d %d %d\n", nx, ny, plid);
+        stream_printf(out, "REGION %d %d %d\n", nx, ny, plid);
     }
     if (uid)
-        fprintf(F, "%d;id\n", uid);
+        stream_printf(out, "%d;id\n", uid);
 }
 
 typedef struct travel_data {
     const faction *f;
-    FILE *file;
+    struct stream *out;
     int n;
 } travel_data;
 
 static void cb_cr_travelthru_ship(region *r, unit *u, void *cbdata) {
     travel_data *data = (travel_data *)cbdata;
     const faction *f = data->f;
-    FILE *F = data->file;
+    struct stream *out = data->out;
 
     if (u->ship && travelthru_cansee(r, f, u)) {
         if (data->n++ == 0) {
-            fprintf(F, "DURCHSCHIFFUNG\n");
+            stream_printf(out, "DURCHSCHIFFUNG\n");
         }
-        fprintf(F, "\"%s\"\n", shipname(u->ship));
+        stream_printf(out, "\"%s\"\n", shipname(u->ship));
     }
 }
 
 static void cb_cr_travelthru_unit(region *r, unit *u, void *cbdata) {
     travel_data *data = (travel_data *)cbdata;
     const faction *f = data->f;
-    FILE *F = data->file;
+    struct stream *out = data->out;
 
     if (!u->ship && travelthru_cansee(r, f, u)) {
         if (data->n++ == 0) {
-            fprintf(F, "DURCHREISE\n");
+            stream_printf(out, "DURCHREISE\n");
         }
-        fprintf(F, "\"%s\"\n", unitname(u));
+        stream_printf(out, "\"%s\"\n", unitname(u));
     }
 }
 
-static void cr_output_travelthru(FILE *F, region *r, const faction *f) {
+static void cr_output_travelthru(struct stream *out, region *r, const faction *f) {
     /* describe both passed and inhabited regions */
     travel_data cbdata = { 0 };
     cbdata.f = f;
-    cbdata.file = F;
+    cbdata.out = out;
     cbdata.n = 0;
     travelthru_map(r, cb_cr_travelthru_ship, &cbdata);
     cbdata.n = 0;
     travelthru_map(r, cb_cr_travelthru_unit, &cbdata);
 }
 
-static void cr_output_region(FILE * F, report_context * ctx, region * r)
+static void cr_output_region(struct stream *out, report_context * ctx, region * r)
 {
     faction *f = ctx->f;
     plane *pl = rplane(r);
@@ -1338,25 +1289,25 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
         }
     }
     while (o--) {
-        cr_region_header(F, plid, oc[o][0], oc[o][1], uid);
-        fputs("\"wrap\";visibility\n", F);
+        cr_region_header(out, plid, oc[o][0], oc[o][1], uid);
+        sputs("\"wrap\";visibility", out);
     }
 
-    cr_region_header(F, plid, nx, ny, uid);
+    cr_region_header(out, plid, nx, ny, uid);
 
     if (r->land) {
         const char *str = rname(r, f->locale);
         if (str && str[0]) {
-            fprintf(F, "\"%s\";Name\n", str);
+            stream_printf(out, "\"%s\";Name\n", str);
         }
     }
     tname = terrain_name(r);
 
-    fprintf(F, "\"%s\";Terrain\n", translate(tname, LOC(f->locale, tname)));
+    stream_printf(out, "\"%s\";Terrain\n", translate(tname, LOC(f->locale, tname)));
     if (r->seen.mode != seen_unit)
-        fprintf(F, "\"%s\";visibility\n", visibility[r->seen.mode]);
+        stream_printf(out, "\"%s\";visibility\n", visibility[r->seen.mode]);
     if (r->seen.mode == seen_neighbour) {
-        cr_borders(r, f, r->seen.mode, F);
+        cr_borders(r, f, r->seen.mode, out);
     }
     else {
         building *b;
@@ -1365,44 +1316,44 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
         int stealthmod = stealth_modifier(r, f, r->seen.mode);
 
         if (r->land && r->land->display && r->land->display[0])
-            fprintf(F, "\"%s\";Beschr\n", r->land->display);
+            stream_printf(out, "\"%s\";Beschr\n", r->land->display);
         if (fval(r->terrain, LAND_REGION)) {
             assert(r->land);
-            fprintf(F, "%d;Bauern\n", rpeasants(r));
-            fprintf(F, "%d;Pferde\n", rhorses(r));
+            stream_printf(out, "%d;Bauern\n", rpeasants(r));
+            stream_printf(out, "%d;Pferde\n", rhorses(r));
 
             if (r->seen.mode >= seen_unit) {
                 if (rule_region_owners()) {
                     faction *owner = region_get_owner(r);
                     if (owner) {
-                        fprintf(F, "%d;owner\n", owner->no);
+                        stream_printf(out, "%d;owner\n", owner->no);
                     }
                 }
-                fprintf(F, "%d;Silber\n", rmoney(r));
+                stream_printf(out, "%d;Silber\n", rmoney(r));
                 if (skill_enabled(SK_ENTERTAINMENT)) {
-                    fprintf(F, "%d;Unterh\n", entertainmoney(r));
+                    stream_printf(out, "%d;Unterh\n", entertainmoney(r));
                 }
                 if (is_cursed(r->attribs, &ct_riotzone)) {
-                    fputs("0;Rekruten\n", F);
+                    sputs("0;Rekruten", out);
                 }
                 else {
-                    fprintf(F, "%d;Rekruten\n", rpeasants(r) / RECRUITFRACTION);
+                    stream_printf(out, "%d;Rekruten\n", rpeasants(r) / RECRUITFRACTION);
                 }
                 if (production(r)) {
                     int p_wage = wage(r, NULL, NULL, turn + 1);
-                    fprintf(F, "%d;Lohn\n", p_wage);
+                    stream_printf(out, "%d;Lohn\n", p_wage);
                     if (is_mourning(r, turn + 1)) {
-                        fputs("1;mourning\n", F);
+                        sputs("1;mourning", out);
                     }
                 }
                 if (r->land && r->land->ownership) {
-                    fprintf(F, "%d;morale\n", region_get_morale(r));
+                    stream_printf(out, "%d;morale\n", region_get_morale(r));
                 }
             }
 
             /* this writes both some tags (RESOURCECOMPAT) and a block.
              * must not write any blocks before it */
-            cr_output_resources_compat(F, ctx, r, r->seen.mode >= seen_unit);
+            cr_output_resources(out, ctx->f, r, r->seen.mode >= seen_unit);
 
             if (r->seen.mode >= seen_unit) {
                 /* trade */
@@ -1410,25 +1361,25 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
                     const item_type *lux = r_luxury(r);
                     const item_type *herb = r->land->herbtype;
                     if (lux || herb) {
-                        fputs("PREISE\n", F);
+                        sputs("PREISE", out);
                         if (lux) {
                             const char *ch = resourcename(lux->rtype, 0);
-                            fprintf(F, "%d;%s\n", 1, translate(ch,
+                            stream_printf(out, "%d;%s\n", 1, translate(ch,
                                 LOC(f->locale, ch)));
                         }
                         if (herb) {
                             const char *ch = resourcename(herb->rtype, 0);
-                            fprintf(F, "%d;%s\n", 1, translate(ch,
+                            stream_printf(out, "%d;%s\n", 1, translate(ch,
                                 LOC(f->locale, ch)));
                         }
                     }
                 }
                 else if (rpeasants(r) / TRADE_FRACTION > 0) {
                     struct demand *dmd = r->land->demands;
-                    fputs("PREISE\n", F);
+                    sputs("PREISE", out);
                     while (dmd) {
                         const char *ch = resourcename(dmd->type->itype->rtype, 0);
-                        fprintf(F, "%d;%s\n", (dmd->value
+                        stream_printf(out, "%d;%s\n", (dmd->value
                             ? dmd->value * dmd->type->price
                             : -dmd->type->price),
                             translate(ch, LOC(f->locale, ch)));
@@ -1437,8 +1388,8 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
                 }
             }
         }
-        cr_output_curses_compat(F, f, r, TYP_REGION);
-        cr_borders(r, f, r->seen.mode, F);
+        cr_output_curses(out, f, r, TYP_REGION);
+        cr_borders(r, f, r->seen.mode, out);
         if (r->seen.mode >= seen_unit && is_astral(r)
             && !is_cursed(r->attribs, &ct_astralblock)) {
             /* Sonderbehandlung Teleport-Ebene */
@@ -1453,20 +1404,20 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
 
                     pnormalize(&nx, &ny, plx);
                     adjust_coordinates(f, &nx, &ny, plx);
-                    fprintf(F, "SCHEMEN %d %d\n", nx, ny);
-                    fprintf(F, "\"%s\";Name\n", rname(r, f->locale));
+                    stream_printf(out, "SCHEMEN %d %d\n", nx, ny);
+                    stream_printf(out, "\"%s\";Name\n", rname(r, f->locale));
                     rl2 = rl2->next;
                 }
                 free_regionlist(rl);
             }
         }
 
-        cr_output_travelthru(F, r, f);
+        cr_output_travelthru(out, r, f);
         if (r->seen.mode >= seen_travel) {
             message_list *mlist = r_getmessages(r, f);
-            cr_output_messages(F, r->msgs, f);
+            cr_output_messages(out, r->msgs, f);
             if (mlist) {
-                cr_output_messages(F, mlist, f);
+                cr_output_messages(out, mlist, f);
             }
         }
         /* buildings */
@@ -1477,7 +1428,7 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
                 const faction *sf = visible_faction(f, u);
                 fno = sf->no;
             }
-            cr_output_building_compat(F, b, u, fno, f);
+            cr_output_building(out, b, u, fno, f);
         }
 
         /* ships */
@@ -1489,7 +1440,7 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
                 fno = sf->no;
             }
 
-            cr_output_ship_compat(F, sh, u, fno, f, r);
+            cr_output_ship(out, sh, u, fno, f, r);
         }
 
         /* visible units */
@@ -1497,12 +1448,16 @@ static void cr_output_region(FILE * F, report_context * ctx, region * r)
 
             if (u->building || u->ship || (stealthmod > INT_MIN
                 && cansee_ex(f, r, u, stealthmod, r->seen.mode))) {
-                cr_output_unit_compat(F, r, f, u, r->seen.mode);
+                cr_output_unit(out, r, f, u, r->seen.mode);
             }
         }
     }
 }
 
+/* the report is written in many small pieces, a large buffer saves most of
+ * the system calls. */
+#define CR_BUFSIZE (1 << 20)
+
 /* main function of the creport. creates the header and traverses all regions */
 static int
 report_computer(const char *filename, report_context * ctx, const char *bom)
@@ -1515,6 +1470,7 @@ report_computer(const char *filename, report_context * ctx, const char *bom)
     const char *mailto = config_get("game.email");
     const attrib *a;
     FILE *F = fopen(filename, "w");
+    stream strm = { 0 }, *out = &strm;
     static const race *rc_human;
     static int rc_cache;
 
@@ -1525,116 +1481,118 @@ report_computer(const char *filename, report_context * ctx, const char *bom)
         perror(filename);
         return -1;
     }
-    else if (bom) {
-        fwrite(bom, 1, strlen(bom), F);
+    setvbuf(F, NULL, _IOFBF, CR_BUFSIZE);
+    fstream_init(&strm, F);
+    if (bom) {
+        swrite(bom, 1, strlen(bom), out);
     }
 
     /* must call this to get all the neighbour regions */
     /* = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = */
     /* initialisations, header and lists */
 
-    fprintf(F, "VERSION %d\n", C_REPORT_VERSION);
-    fprintf(F, "\"UTF-8\";charset\n\"%s\";locale\n",
+    stream_printf(out, "VERSION %d\n", C_REPORT_VERSION);
+    stream_printf(out, "\"UTF-8\";charset\n\"%s\";locale\n",
         locale_name(f->locale));
-    fprintf(F, "%d;noskillpoints\n", 1);
-    fprintf(F, "%lld;date\n", (long long)ctx->report_time);
-    fprintf(F, "\"%s\";Spiel\n", game_name());
-    fprintf(F, "\"%s\";Konfiguration\n", "Standard");
-    fprintf(F, "\"%s\";Koordinaten\n", "Hex");
-    fprintf(F, "%d;max_units\n", rule_faction_limit());
-    fprintf(F, "%d;Basis\n", 36);
-    fprintf(F, "%d;Runde\n", turn);
-    fprintf(F, "%d;Zeitalter\n", era);
-    fprintf(F, "\"%s\";Build\n", eressea_version());
+    stream_printf(out, "%d;noskillpoints\n", 1);
+    stream_printf(out, "%lld;date\n", (long long)ctx->report_time);
+    stream_printf(out, "\"%s\";Spiel\n", game_name());
+    stream_printf(out, "\"%s\";Konfiguration\n", "Standard");
+    stream_printf(out, "\"%s\";Koordinaten\n", "Hex");
+    stream_printf(out, "%d;max_units\n", rule_faction_limit());
+    stream_printf(out, "%d;Basis\n", 36);
+    stream_printf(out, "%d;Runde\n", turn);
+    stream_printf(out, "%d;Zeitalter\n", era);
+    stream_printf(out, "\"%s\";Build\n", eressea_version());
     if (mailto != NULL) {
         const char * mailcmd = get_mailcmd(f->locale);
-        fprintf(F, "\"%s\";mailto\n", mailto);
-        fprintf(F, "\"%s\";mailcmd\n", mailcmd);
+        stream_printf(out, "\"%s\";mailto\n", mailto);
+        stream_printf(out, "\"%s\";mailcmd\n", mailcmd);
     }
 
-    show_alliances_cr(F, f);
+    show_alliances_cr(out, f);
 
-    fprintf(F, "PARTEI %d\n", f->no);
-    fprintf(F, "\"%s\";locale\n", locale_name(f->locale));
+    stream_printf(out, "PARTEI %d\n", f->no);
+    stream_printf(out, "\"%s\";locale\n", locale_name(f->locale));
     if (f_get_alliance(f)) {
-        fprintf(F, "%d;alliance\n", f->alliance->id);
-        fprintf(F, "%d;joined\n", f->alliance_joindate);
+        stream_printf(out, "%d;alliance\n", f->alliance->id);
+        stream_printf(out, "%d;joined\n", f->alliance_joindate);
     }
-    fprintf(F, "%d;age\n", f->age);
-    fprintf(F, "%d;Optionen\n", f->options);
+    stream_printf(out, "%d;age\n", f->age);
+    stream_printf(out, "%d;Optionen\n", f->options);
     if (f->options & want(O_SCORE) && f->age > DISPLAYSCORE) {
         char score[32];
         write_score(score, sizeof(score), f->score);
-        fprintf(F, "%s;Punkte\n", score);
+        stream_printf(out, "%s;Punkte\n", score);
         write_score(score, sizeof(score), average_score_of_age(f->age, f->age / 24 + 1));
-        fprintf(F, "%s;Punktedurchschnitt\n", score);
+        stream_printf(out, "%s;Punktedurchschnitt\n", score);
     }
     {
         const char *zRace = rc_name_s(f->race, NAME_PLURAL);
-        fprintf(F, "\"%s\";Typ\n", translate(zRace, LOC(f->locale, zRace)));
+        stream_printf(out, "\"%s\";Typ\n", translate(zRace, LOC(f->locale, zRace)));
     }
     prefix = get_prefix(f->attribs);
     if (prefix != NULL) {
         prefix = mkname("prefix", prefix);
-        fprintf(F, "\"%s\";typprefix\n",
+        stream_printf(out, "\"%s\";typprefix\n",
             translate(prefix, LOC(f->locale, prefix)));
     }
-    fprintf(F, "%d;Rekrutierungskosten\n", f->race->recruitcost);
-    fprintf(F, "%d;Anzahl Personen\n", f->num_people);
-    fprintf(F, "\"%s\";Magiegebiet\n", magic_school[f->magiegebiet]);
+    stream_printf(out, "%d;Rekrutierungskosten\n", f->race->recruitcost);
+    stream_printf(out, "%d;Anzahl Personen\n", f->num_people);
+    stream_printf(out, "\"%s\";Magiegebiet\n", magic_school[f->magiegebiet]);
 
     if (rc_changed(&rc_cache)) {
         rc_human = rc_find("human");
     }
     if (f->race == rc_human) {
-        fprintf(F, "%d;Anzahl Immigranten\n", count_migrants(f));
-        fprintf(F, "%d;Max. Immigranten\n", count_maxmigrants(f));
+        stream_printf(out, "%d;Anzahl Immigranten\n", count_migrants(f));
+        stream_printf(out, "%d;Max. Immigranten\n", count_maxmigrants(f));
     }
 
     i = countheroes(f);
     if (i > 0)
-        fprintf(F, "%d;heroes\n", i);
+        stream_printf(out, "%d;heroes\n", i);
     i = maxheroes(f);
     if (i > 0)
-        fprintf(F, "%d;max_heroes\n", i);
+        stream_printf(out, "%d;max_heroes\n", i);
 
     if (f->age > 1 && f->lastorders != turn) {
-        fprintf(F, "%d;nmr\n", turn - f->lastorders);
+        stream_printf(out, "%d;nmr\n", turn - f->lastorders);
     }
 
-    fprintf(F, "\"%s\";Parteiname\n", f->name);
-    fprintf(F, "\"%s\";email\n", faction_getemail(f));
+    stream_printf(out, "\"%s\";Parteiname\n", f->name);
+    stream_printf(out, "\"%s\";email\n", faction_getemail(f));
     if (f->banner)
-        fprintf(F, "\"%s\";banner\n", f->banner);
-    print_items(F, f->items, f->locale);
-    fputs("OPTIONEN\n", F);
+        stream_printf(out, "\"%s\";banner\n", f->banner);
+    print_items(out, f->items, f->locale);
+    sputs("OPTIONEN", out);
     for (i = 0; i != MAXOPTIONS; ++i) {
         int flag = want(i);
         if (options[i]) {
-            fprintf(F, "%d;%s\n", (f->options & flag) ? 1 : 0, options[i]);
+            stream_printf(out, "%d;%s\n", (f->options & flag) ? 1 : 0, options[i]);
         }
         else if (f->options & flag) {
             f->options &= (~flag);
         }
     }
-    show_allies_cr(F, f, f->allies);
+    show_allies_cr(out, f, f->allies);
     {
         group *g;
         for (g = f->groups; g; g = g->next) {
 
-            fprintf(F, "GRUPPE %d\n", g->gid);
-            fprintf(F, "\"%s\";name\n", g->name);
+            stream_printf(out, "GRUPPE %d\n", g->gid);
+            stream_printf(out, "\"%s\";name\n", g->name);
             prefix = get_prefix(g->attribs);
             if (prefix != NULL) {
                 prefix = mkname("prefix", prefix);
-                fprintf(F, "\"%s\";typprefix\n",
+                stream_printf(out, "\"%s\";typprefix\n",
                     translate(prefix, LOC(f->locale, prefix)));
             }
-            show_allies_cr(F, f, g->allies);
+            show_allies_cr(out, f, g->allies);
         }
     }
 
-    cr_output_messages(F, f->msgs, f);
+    cr_output_messages(out, f->msgs, f);
     {
         struct bmsg *bm;
         for (bm = f->battles; bm; bm = bm->next) {
@@ -1646,19 +1604,19 @@ report_computer(const char *filename, report_context * ctx, const char *bom)
             pnormalize(&nx, &ny, pl);
             adjust_coordinates(f, &nx, &ny, pl);
             if (!plid)
-                fprintf(F, "BATTLE %d %d\n", nx, ny);
+                stream_printf(out, "BATTLE %d %d\n", nx, ny);
             else {
-                fprintf(F, "BATTLE %d %d %d\n", nx, ny, plid);
+                stream_printf(out, "BATTLE %d %d %d\n", nx, ny, plid);
             }
-            cr_output_messages(F, bm->msgs, f);
+            cr_output_messages(out, bm->msgs, f);
         }
     }
 
-    cr_find_address(F, f, ctx->addresses);
+    cr_find_address(out, f, ctx->addresses);
     a = a_find(f->attribs, &at_reportspell);
     while (a && a->type == &at_reportspell) {
         spellbook_entry *sbe = (spellbook_entry *)a->data.v;
-        cr_reportspell(F, sbe->sp, sbe->level, f->locale);
+        cr_reportspell(out, sbe->sp, sbe->level, f->locale);
         a = a->next;
     }
     for (a = a_find(f->attribs, &at_showitem); a && a->type == &at_showitem;
@@ -1671,9 +1629,9 @@ report_computer(const char *filename, report_context * ctx, const char *bom)
         if (ptype == NULL)
             continue;
         ch = resourcename(ptype->itype->rtype, 0);
-        fprintf(F, "TRANK %d\n", hashstring(ch));
-        fprintf(F, "\"%s\";Name\n", translate(ch, LOC(f->locale, ch)));
-        fprintf(F, "%d;Stufe\n", ptype->level);
+        stream_printf(out, "TRANK %d\n", hashstring(ch));
+        stream_printf(out, "\"%s\";Name\n", translate(ch, LOC(f->locale, ch)));
+        stream_printf(out, "%d;Stufe\n", ptype->level);
 
         if (description == NULL) {
             const char *pname = resourcename(ptype->itype->rtype, 0);
@@ -1681,15 +1639,15 @@ report_computer(const char *filename, report_context * ctx, const char *bom)
             description = LOC(f->locale, potiontext);
         }
 
-        fprintf(F, "\"%s\";Beschr\n", description);
+        stream_printf(out, "\"%s\";Beschr\n", description);
         if (ptype->itype->construction) {
             requirement *m = ptype->itype->construction->materials;
 
-            fprintf(F, "ZUTATEN\n");
+            stream_printf(out, "ZUTATEN\n");
 
             while (m->number) {
                 ch = resourcename(m->rtype, 0);
-                fprintf(F, "\"%s\"\n", translate(ch, LOC(f->locale, ch)));
+                stream_printf(out, "\"%s\"\n", translate(ch, LOC(f->locale, ch)));
                 m++;
             }
         }
@@ -1698,40 +1656,43 @@ report_computer(const char *filename, report_context * ctx, const char *bom)
     /* traverse all regions */
     for (r = ctx->first; r != ctx->last; r = r->next) {
         if (r->seen.mode > seen_none) {
-            cr_output_region(F, ctx, r);
+            cr_output_region(out, ctx, r);
         }
     }
-    report_crtypes(F, f->locale);
+    report_crtypes(out, f->locale);
     if (f->locale != crtag_locale()) {
-        report_translations(F);
+        report_translations(out);
     }
     reset_translations();
-    fclose(F);
+    fstream_done(&strm);
     return 0;
 }
 
 int crwritemap(const char *filename)
 {
     FILE *F = fopen(filename, "w");
+    stream strm = { 0 }, *out = &strm;
     region *r;
 
     if (F) {
-        fprintf(F, "VERSION %d\n", C_REPORT_VERSION);
-        fputs("\"UTF-8\";charset\n", F);
+        setvbuf(F, NULL, _IOFBF, CR_BUFSIZE);
+        fstream_init(&strm, F);
+        stream_printf(out, "VERSION %d\n", C_REPORT_VERSION);
+        sputs("\"UTF-8\";charset", out);
 
         for (r = regions; r; r = r->next) {
             plane *pl = rplane(r);
             int plid = plane_id(pl);
             if (plid) {
-                fprintf(F, "REGION %d %d %d\n", r->x, r->y, plid);
+                stream_printf(out, "REGION %d %d %d\n", r->x, r->y, plid);
             }
             else {
-                fprintf(F, "REGION %d %d\n", r->x, r->y);
+                stream_printf(out, "REGION %d %d\n", r->x, r->y);
             }
-            fprintf(F, "\"%s\";Name\n\"%s\";Terrain\n", rname(r, default_locale),
+            stream_printf(out, "\"%s\";Name\n\"%s\";Terrain\n", rname(r, default_locale),
                 LOC(default_locale, terrain_name(r)));
         }
-        fclose(F);
+        fstream_done(&strm);
         return 0;
     }
     return EOF;
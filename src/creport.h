@@ -27,6 +27,8 @@ extern "C" {
     void register_cr(void);
 
     int crwritemap(const char *filename);
+    /* writes str in quotes, returns the number of bytes written */
+    int swritestr(struct stream *out, const char *str);
     void cr_output_unit(struct stream *out, const struct region * r,
         const struct faction * f, const struct unit * u, seen_mode mode);
     void cr_output_resources(struct stream *out, const struct faction * f,
@@ -51,6 +51,20 @@ static void test_cr_unit(CuTest *tc) {
     test_cleanup();
 }
 
+static void test_swritestr(CuTest *tc) {
+    stream strm;
+    char line[64];
+
+    mstream_init(&strm);
+    CuAssertIntEquals(tc, 20, swritestr(&strm, "say \"hi\"\\n\nbye"));
+    CuAssertIntEquals(tc, 2, swritestr(&strm, NULL));
+    strm.api->writeln(strm.handle, "");
+    strm.api->rewind(strm.handle);
+    CuAssertIntEquals(tc, 0, strm.api->readln(strm.handle, line, sizeof(line)));
+    CuAssertStrEquals(tc, "\"say \\\"hi\\\"\\\\n\\nbye\"\"\"", line);
+    mstream_done(&strm);
+}
+
 static void setup_resources(void) {
     struct locale *lang;
     item_type *itype;
@@ -326,6 +340,7 @@ CuSuite *get_creport_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
     SUITE_ADD_TEST(suite, test_cr_unit);
+    SUITE_ADD_TEST(suite, test_swritestr);
     SUITE_ADD_TEST(suite, test_cr_resources);
     SUITE_ADD_TEST(suite, test_cr_mallorn);
     SUITE_ADD_TEST(suite, test_cr_factionstealth);
@@ -79,6 +79,41 @@ static int tolua_eressea_eressea_read_game00(lua_State* tolua_S)
 #endif
 }
 
+/* function: eressea_read_game_area */
+static int tolua_eressea_eressea_read_game_area00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+ !tolua_isstring(tolua_S,1,0,&tolua_err) || 
+ !tolua_isnumber(tolua_S,2,0,&tolua_err) || 
+ !tolua_isnumber(tolua_S,3,0,&tolua_err) || 
+ !tolua_isnumber(tolua_S,4,0,&tolua_err) || 
+ !tolua_isnumber(tolua_S,5,0,&tolua_err) || 
+ !tolua_isnoobj(tolua_S,6,&tolua_err)
+ )
+ goto tolua_lerror;
+ else
+#endif
+ {
+  const char* filename = ((const char*)  tolua_tostring(tolua_S,1,0));
+  int left = ((int)  tolua_tonumber(tolua_S,2,0));
+  int bottom = ((int)  tolua_tonumber(tolua_S,3,0));
+  int right = ((int)  tolua_tonumber(tolua_S,4,0));
+  int top = ((int)  tolua_tonumber(tolua_S,5,0));
+ {
+  int tolua_ret = (int)  eressea_read_game_area(filename,left,bottom,right,top);
+ tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+ }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'read_game_area'.",&tolua_err);
+ return 0;
+#endif
+}
+
 /* function: eressea_write_game */
 static int tolua_eressea_eressea_write_game00(lua_State* tolua_S)
 {
@@ -106,6 +141,85 @@ static int tolua_eressea_eressea_write_game00(lua_State* tolua_S)
 #endif
 }
 
+/* function: eressea_write_game_async */
+static int tolua_eressea_eressea_write_game_async00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+ !tolua_isstring(tolua_S,1,0,&tolua_err) || 
+ !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+ goto tolua_lerror;
+ else
+#endif
+ {
+  const char* filename = ((const char*)  tolua_tostring(tolua_S,1,0));
+ {
+  int tolua_ret = (int)  eressea_write_game_async(filename);
+ tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+ }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'write_game_async'.",&tolua_err);
+ return 0;
+#endif
+}
+
+/* function: eressea_wait_game */
+static int tolua_eressea_eressea_wait_game00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+ !tolua_isnoobj(tolua_S,1,&tolua_err)
+ )
+ goto tolua_lerror;
+ else
+#endif
+ {
+ {
+  int tolua_ret = (int)  eressea_wait_game();
+ tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+ }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'wait_game'.",&tolua_err);
+ return 0;
+#endif
+}
+
+/* function: eressea_verify_game */
+static int tolua_eressea_eressea_verify_game00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+ !tolua_isstring(tolua_S,1,0,&tolua_err) || 
+ !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+ goto tolua_lerror;
+ else
+#endif
+ {
+  const char* filename = ((const char*)  tolua_tostring(tolua_S,1,0));
+ {
+  int tolua_ret = (int)  eressea_verify_game(filename);
+ tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+ }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'verify_game'.",&tolua_err);
+ return 0;
+#endif
+}
+
 /* function: eressea_read_orders */
 static int tolua_eressea_eressea_read_orders00(lua_State* tolua_S)
 {
@@ -189,6 +303,33 @@ static int tolua_eressea_eressea_import00(lua_State* tolua_S)
 #endif
 }
 
+/* function: eressea_export_columns */
+static int tolua_eressea_eressea_export_columns00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+ !tolua_isstring(tolua_S,1,0,&tolua_err) || 
+ !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+ goto tolua_lerror;
+ else
+#endif
+ {
+  const char* path = ((const char*)  tolua_tostring(tolua_S,1,0));
+ {
+  int tolua_ret = (int)  eressea_export_columns(path);
+ tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+ }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'export_columns'.",&tolua_err);
+ return 0;
+#endif
+}
+
 /* Open lib function */
 LUALIB_API int luaopen_eressea (lua_State* tolua_S)
 {
@@ -200,10 +341,15 @@ LUALIB_API int luaopen_eressea (lua_State* tolua_S)
  tolua_beginmodule(tolua_S,"eressea");
  tolua_function(tolua_S,"free_game",tolua_eressea_eressea_free_game00);
  tolua_function(tolua_S,"read_game",tolua_eressea_eressea_read_game00);
+ tolua_function(tolua_S,"read_game_area",tolua_eressea_eressea_read_game_area00);
  tolua_function(tolua_S,"write_game",tolua_eressea_eressea_write_game00);
+ tolua_function(tolua_S,"write_game_async",tolua_eressea_eressea_write_game_async00);
+ tolua_function(tolua_S,"wait_game",tolua_eressea_eressea_wait_game00);
+ tolua_function(tolua_S,"verify_game",tolua_eressea_eressea_verify_game00);
  tolua_function(tolua_S,"read_orders",tolua_eressea_eressea_read_orders00);
  tolua_function(tolua_S,"export",tolua_eressea_eressea_export00);
  tolua_function(tolua_S,"import",tolua_eressea_eressea_import00);
+ tolua_function(tolua_S,"export_columns",tolua_eressea_eressea_export_columns00);
  tolua_endmodule(tolua_S);
  tolua_endmodule(tolua_S);
  return 1;
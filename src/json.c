@@ -11,113 +11,290 @@
 #include <stream.h>
 #include "cJSON.h"
 
+#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <stdbool.h>
 
-int json_import(struct stream * out) {
-    cJSON *json, *child;
-    char buffer[1024], *data = 0;
-    size_t sz = 0;
-    assert(out && out->api);
-    while (!out->api->readln(out->handle, buffer, sizeof(buffer))) {
-        size_t len = strlen(buffer);
-        char *tmp;
-        tmp = (char *)realloc(data, sz + len + 1);
-        if (!tmp) {
-            log_fatal("allocation failure in json_import");
-            free(data);
-            return 1;
+static void import_region(int id, cJSON *j) {
+    cJSON *attr;
+    int x = 0, y = 0;
+    region * r;
+
+    if ((attr = cJSON_GetObjectItem(j, "x")) != 0 && attr->type == cJSON_Number) x = attr->valueint;
+    if ((attr = cJSON_GetObjectItem(j, "y")) != 0 && attr->type == cJSON_Number) y = attr->valueint;
+    r = new_region(x, y, 0, id);
+    if ((attr = cJSON_GetObjectItem(j, "type")) != 0 && attr->type == cJSON_String) {
+        const terrain_type *terrain = get_terrain(attr->valuestring);
+        terraform_region(r, terrain);
+    }
+    if ((attr = cJSON_GetObjectItem(j, "name")) != 0 && attr->type == cJSON_String) {
+        region_setname(r, attr->valuestring);
+    }
+}
+
+/* reads the input in blocks, and hands each member of the "regions"
+ * object to cJSON on its own, so only one region is in memory at once. */
+typedef struct json_reader {
+    stream *in;
+    char buf[4096];
+    size_t pos, len;
+    char *data; /* text of the current value */
+    size_t size, used;
+} json_reader;
+
+static int jr_peek(json_reader *jr) {
+    if (jr->pos == jr->len) {
+        jr->pos = 0;
+        jr->len = jr->in->api->read(jr->in->handle, jr->buf, sizeof(jr->buf));
+        if (jr->len == 0) {
+            return EOF;
+        }
+    }
+    return (unsigned char)jr->buf[jr->pos];
+}
+
+static int jr_get(json_reader *jr) {
+    int c = jr_peek(jr);
+    if (c != EOF) {
+        ++jr->pos;
+    }
+    return c;
+}
+
+static int jr_skip_ws(json_reader *jr) {
+    int c = jr_peek(jr);
+    while (c != EOF && isspace(c)) {
+        ++jr->pos;
+        c = jr_peek(jr);
+    }
+    return c;
+}
+
+static void jr_keep(json_reader *jr, bool keep, int c) {
+    if (keep) {
+        if (jr->used + 1 >= jr->size) {
+            jr->size = jr->size ? jr->size * 2 : 1024;
+            jr->data = realloc(jr->data, jr->size);
         }
-        data = tmp;
-        memcpy(data + sz, buffer, len);
-        sz += len;
-        data[sz] = 0;
-    }
-    json = cJSON_Parse(data);
-    free(data);
-    child = cJSON_GetObjectItem(json, "regions");
-    if (child && child->type == cJSON_Object) {
-        cJSON *j;
-        for (j = child->child; j; j = j->next) {
-            cJSON *attr;
-            int id = 0;
-            int x = 0, y = 0;
-            region * r;
-
-            id = atoi(j->string);
-            if ((attr = cJSON_GetObjectItem(j, "x")) != 0 && attr->type == cJSON_Number) x = attr->valueint;
-            if ((attr = cJSON_GetObjectItem(j, "y")) != 0 && attr->type == cJSON_Number) y = attr->valueint;
-            r = new_region(x, y, 0, id);
-            if ((attr = cJSON_GetObjectItem(j, "type")) != 0 && attr->type == cJSON_String) {
-                const terrain_type *terrain = get_terrain(attr->valuestring);
-                terraform_region(r, terrain);
+        jr->data[jr->used++] = (char)c;
+        jr->data[jr->used] = '\0';
+    }
+}
+
+/* copies the next value (object, array, string or scalar) to jr->data
+ * if keep is set, or skips over it. returns false on bad input. */
+static bool jr_value(json_reader *jr, bool keep) {
+    int c, depth = 0;
+    bool quoted = false;
+
+    jr->used = 0;
+    jr_skip_ws(jr);
+    while ((c = jr_peek(jr)) != EOF) {
+        if (quoted) {
+            jr_keep(jr, keep, jr_get(jr));
+            if (c == '\\') {
+                c = jr_get(jr);
+                if (c == EOF) break;
+                jr_keep(jr, keep, c);
+            }
+            else if (c == '"') {
+                quoted = false;
+                if (depth == 0) return true;
+            }
+        }
+        else if (c == '"') {
+            jr_keep(jr, keep, jr_get(jr));
+            quoted = true;
+        }
+        else if (c == '{' || c == '[') {
+            jr_keep(jr, keep, jr_get(jr));
+            ++depth;
+        }
+        else if (c == '}' || c == ']' || c == ',') {
+            if (depth == 0) {
+                /* end of a scalar */
+                return jr->used > 0 || !keep;
             }
-            if ((attr = cJSON_GetObjectItem(j, "name")) != 0 && attr->type == cJSON_String) {
-                region_setname(r, attr->valuestring);
+            jr_keep(jr, keep, jr_get(jr));
+            if (c != ',' && --depth == 0) {
+                return true;
             }
         }
+        else {
+            jr_keep(jr, keep, jr_get(jr));
+        }
+    }
+    return false;
+}
+
+/* reads the key of an object member and the colon after it */
+static bool jr_key(json_reader *jr, char *key, size_t size) {
+    size_t len = 0;
+    int c;
+
+    if (jr_skip_ws(jr) != '"') {
+        return false;
+    }
+    jr_get(jr);
+    while ((c = jr_get(jr)) != '"') {
+        if (c == EOF) return false;
+        if (c == '\\') c = jr_get(jr);
+        if (len + 1 < size) key[len++] = (char)c;
+    }
+    key[len] = '\0';
+    if (jr_skip_ws(jr) != ':') {
+        return false;
+    }
+    jr_get(jr);
+    return true;
+}
+
+/* calls member for each member of the object at the current position */
+static bool jr_object(json_reader *jr, bool(*member)(json_reader *, const char *)) {
+    char key[64];
+    int c;
+
+    if (jr_skip_ws(jr) != '{') {
+        return false;
+    }
+    jr_get(jr);
+    for (;;) {
+        c = jr_skip_ws(jr);
+        if (c == '}') {
+            jr_get(jr);
+            return true;
+        }
+        if (c == ',') {
+            jr_get(jr);
+        }
+        else if (!jr_key(jr, key, sizeof(key)) || !member(jr, key)) {
+            return false;
+        }
+    }
+}
+
+static bool import_region_member(json_reader *jr, const char *key) {
+    cJSON *json;
+
+    if (!jr_value(jr, true)) {
+        return false;
+    }
+    json = cJSON_Parse(jr->data);
+    if (!json) {
+        return false;
+    }
+    if (json->type == cJSON_Object) {
+        import_region(atoi(key), json);
     }
     cJSON_Delete(json);
+    return true;
+}
+
+static bool import_member(json_reader *jr, const char *key) {
+    if (strcmp(key, "regions") == 0 && jr_skip_ws(jr) == '{') {
+        return jr_object(jr, import_region_member);
+    }
+    return jr_value(jr, false);
+}
+
+int json_import(struct stream * out) {
+    json_reader jr;
+    bool ok;
+
+    assert(out && out->api);
+    memset(&jr, 0, sizeof(jr));
+    jr.in = out;
+    ok = jr_object(&jr, import_member);
+    free(jr.data);
+    if (!ok) {
+        log_error("json_import: invalid input");
+        return 1;
+    }
     return 0;
 }
 
+/* writes the members of an object one per line, each of them printed
+ * by cJSON on its own, so the whole document is never in memory. */
+static void export_member(stream *out, bool *first, const char *key, cJSON *data) {
+    char *text = cJSON_PrintUnformatted(data);
+    size_t len = strlen(text) + strlen(key) + 8;
+    char *line = malloc(len);
+
+    snprintf(line, len, "%s\"%s\": %s", *first ? "" : ",", key, text);
+    out->api->writeln(out->handle, line);
+    *first = false;
+    free(line);
+    free(text);
+    cJSON_Delete(data);
+}
+
+static void export_section(stream *out, bool *first, const char *name) {
+    char line[64];
+    snprintf(line, sizeof(line), "%s\"%s\": {", *first ? "" : ",", name);
+    out->api->writeln(out->handle, line);
+    *first = false;
+}
+
 int json_export(stream * out, int flags) {
-    cJSON *json, *root = cJSON_CreateObject();
+    bool first = true;
+
     assert(out && out->api);
+    if (flags) {
+        out->api->writeln(out->handle, "{");
+    }
     if (regions && (flags & EXPORT_REGIONS)) {
         char id[32]; /* TODO: static_assert(INT_MAX < 10^32) */
         region * r;
         plane * p;
-        cJSON_AddItemToObject(root, "planes", json = cJSON_CreateObject());
+        bool empty = true;
+
+        export_section(out, &first, "planes");
         for (p = planes; p; p = p->next) {
-            cJSON *data;
+            cJSON *data = cJSON_CreateObject();
             sprintf(id, "%d", p->id); /* safe, unless int is bigger than 64 bit */
-            cJSON_AddItemToObject(json, id, data = cJSON_CreateObject());
             cJSON_AddNumberToObject(data, "x", p->minx);
             cJSON_AddNumberToObject(data, "y", p->miny);
             cJSON_AddNumberToObject(data, "width", p->maxx - p->minx);
             cJSON_AddNumberToObject(data, "height", p->maxy - p->miny);
             if (p->name) cJSON_AddStringToObject(data, "name", p->name);
+            export_member(out, &empty, id, data);
         }
+        out->api->writeln(out->handle, "}");
 
-        cJSON_AddItemToObject(root, "regions", json = cJSON_CreateObject());
+        empty = true;
+        export_section(out, &first, "regions");
         for (r = regions; r; r = r->next) {
-            cJSON *data;
+            cJSON *data = cJSON_CreateObject();
             sprintf(id, "%d", r->uid); /* safe, unless int is bigger than 64 bit */
-            cJSON_AddItemToObject(json, id, data = cJSON_CreateObject());
             cJSON_AddNumberToObject(data, "x", r->x);
             cJSON_AddNumberToObject(data, "y", r->y);
             cJSON_AddStringToObject(data, "type", r->terrain->_name);
             if (r->land) {
                 cJSON_AddStringToObject(data, "name", r->land->name);
             }
+            export_member(out, &empty, id, data);
         }
+        out->api->writeln(out->handle, "}");
     }
     if (factions && (flags & EXPORT_FACTIONS)) {
         faction *f;
-        cJSON_AddItemToObject(root, "factions", json = cJSON_CreateObject());
+        bool empty = true;
+
+        export_section(out, &first, "factions");
         for (f = factions; f; f = f->next) {
-            cJSON *data;
-            cJSON_AddItemToObject(json, itoa36(f->no), data = cJSON_CreateObject());
+            cJSON *data = cJSON_CreateObject();
             cJSON_AddStringToObject(data, "name", f->name);
             cJSON_AddStringToObject(data, "email", faction_getemail(f));
             cJSON_AddNumberToObject(data, "score", (double)f->score);
+            export_member(out, &empty, itoa36(f->no), data);
         }
+        out->api->writeln(out->handle, "}");
     }
     if (flags) {
-        char *tok, *output;
-        output = cJSON_Print(root);
-        tok = strtok(output, "\n\r");
-        while (tok) {
-            if (tok[0]) {
-                out->api->writeln(out->handle, tok);
-            }
-            tok = strtok(NULL, "\n\r");
-        }
-        free(output);
+        out->api->writeln(out->handle, "}");
     }
-    cJSON_Delete(root);
     return 0;
 }
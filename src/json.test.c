@@ -3,6 +3,7 @@
 #include <stream.h>
 #include <memstream.h>
 
+#include <kernel/config.h>
 #include <kernel/region.h>
 #include <kernel/terrain.h>
 
@@ -127,11 +128,51 @@ static void test_export_no_factions(CuTest * tc) {
     test_cleanup();
 }
 
+static void test_import_regions(CuTest * tc) {
+    stream out = { 0 };
+    struct terrain_type *terrain;
+    region *r;
+    int uid;
+
+    test_setup();
+    terrain = test_create_terrain("plain", LAND_REGION);
+    r = test_create_region(1, 2, terrain);
+    region_setname(r, "{\"Hello\"}");
+    uid = r->uid;
+    test_create_region(3, 4, test_create_terrain("ocean", SEA_REGION));
+    mstream_init(&out);
+    CuAssertIntEquals(tc, 0, json_export(&out, EXPORT_REGIONS | EXPORT_FACTIONS));
+    free_gamedata();
+    out.api->rewind(out.handle);
+    CuAssertIntEquals(tc, 0, json_import(&out));
+    mstream_done(&out);
+    CuAssertPtrNotNull(tc, r = findregion(1, 2));
+    CuAssertIntEquals(tc, uid, r->uid);
+    CuAssertPtrEquals(tc, terrain, (void *)r->terrain);
+    CuAssertStrEquals(tc, "{\"Hello\"}", r->land->name);
+    CuAssertPtrNotNull(tc, findregion(3, 4));
+    test_cleanup();
+}
+
+static void test_import_invalid(CuTest * tc) {
+    stream out = { 0 };
+
+    test_setup();
+    mstream_init(&out);
+    out.api->writeln(out.handle, "{ \"regions\": { \"1\": {");
+    out.api->rewind(out.handle);
+    CuAssertIntEquals(tc, 1, json_import(&out));
+    mstream_done(&out);
+    test_cleanup();
+}
+
 CuSuite *get_json_suite(void) {
     CuSuite *suite = CuSuiteNew();
     SUITE_ADD_TEST(suite, test_export_no_regions);
     SUITE_ADD_TEST(suite, test_export_ocean_region);
     SUITE_ADD_TEST(suite, test_export_land_region);
     SUITE_ADD_TEST(suite, test_export_no_factions);
+    SUITE_ADD_TEST(suite, test_import_regions);
+    SUITE_ADD_TEST(suite, test_import_invalid);
     return suite;
 }
@@ -64,6 +64,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <util/lists.h>
 #include <util/parser.h>
 #include <util/rand.h>
+#include <util/resolve.h>
 #include <util/rng.h>
 #include <util/translation.h>
 #include <util/umlaut.h>
@@ -260,6 +261,13 @@ param_t getparam(const struct locale * lang)
     return s ? findparam(s, lang) : NOPARAM;
 }
 
+param_t parser_param(struct parser_state *ps, const struct locale * lang)
+{
+    char token[64];
+    const char *s = parser_token(ps, token, sizeof(token));
+    return s ? findparam(s, lang) : NOPARAM;
+}
+
 unit *getnewunit(const region * r, const faction * f)
 {
     int n;
@@ -837,6 +845,7 @@ void free_gamedata(void)
     free_regions();
     free_borders();
     free_alliances();
+    ur_reset();
 
     while (global.attribs) {
         a_remove(&global.attribs, global.attribs);
@@ -29,6 +29,7 @@ extern "C" {
 #include "types.h"
 
     struct param;
+    struct parser_state;
     struct _dictionary_;
 
 #define DISPLAYSIZE         8192        /* max. L�nge einer Beschreibung, incl trailing 0 */
@@ -49,6 +50,7 @@ extern "C" {
     param_t findparam_ex(const char *s, const struct locale * lang);
     bool isparam(const char *s, const struct locale * lang, param_t param);
     param_t getparam(const struct locale *lang);
+    param_t parser_param(struct parser_state *ps, const struct locale *lang);
 
     const char * game_name(void);
     const char * game_mailcmd(void);
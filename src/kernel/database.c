@@ -11,10 +11,90 @@
 
 #include "db/driver.h"
 
+#include <critbit.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* direct-mapped cache of order_data, indexed by id modulo its size.
+ * every entry holds one reference to its data. */
+typedef struct cache_entry {
+    int id;
+    order_data *data;
+} cache_entry;
+
+static cache_entry *g_cache;
+static int g_cache_size;
+static int g_cache_hits, g_cache_misses;
+
+/* index of all order texts saved in this session, text -> id.
+ * identical orders share a single database record. */
+static critbit_tree g_index;
+
+static int index_find(const char *str, size_t len)
+{
+    void *match;
+    if (cb_find_prefix(&g_index, str, len + 1, &match, 1, 0) > 0) {
+        int id;
+        cb_get_kv(match, &id, sizeof(id));
+        return id;
+    }
+    return 0;
+}
+
+static void index_insert(const char *str, size_t len, int id)
+{
+    char buffer[DISPLAYSIZE + sizeof(int) + 1];
+
+    assert(len + 1 + sizeof(id) <= sizeof(buffer));
+    len = cb_new_kv(str, len, &id, sizeof(id), buffer);
+    cb_insert(&g_index, buffer, len);
+}
+
+static void cache_insert(int id, order_data *od)
+{
+    if (g_cache) {
+        cache_entry *entry = g_cache + (id % g_cache_size);
+        if (entry->data != od) {
+            odata_release(entry->data);
+            odata_addref(od);
+            entry->data = od;
+        }
+        entry->id = id;
+    }
+}
+
+static void cache_clear(void)
+{
+    if (g_cache) {
+        int i;
+        for (i = 0; i != g_cache_size; ++i) {
+            odata_release(g_cache[i].data);
+        }
+        free(g_cache);
+        g_cache = NULL;
+    }
+}
+
 order_data *dblib_load_order(int id)
 {
     if (id > 0) {
-        return db_driver_order_load(id);
+        order_data *od;
+        if (g_cache) {
+            cache_entry *entry = g_cache + (id % g_cache_size);
+            if (entry->id == id && entry->data) {
+                ++g_cache_hits;
+                odata_addref(entry->data);
+                return entry->data;
+            }
+            ++g_cache_misses;
+        }
+        od = db_driver_order_load(id);
+        if (od) {
+            cache_insert(id, od);
+        }
+        return od;
     }
     return NULL;
 }
@@ -22,17 +102,57 @@ order_data *dblib_load_order(int id)
 int dblib_save_order(order_data *od)
 {
     if (od->_str) {
-        return db_driver_order_save(od);
+        size_t len = strlen(od->_str);
+        /* very long texts are rare, and not worth indexing */
+        bool indexed = len < DISPLAYSIZE;
+        int id = indexed ? index_find(od->_str, len) : 0;
+        if (id == 0) {
+            id = db_driver_order_save(od);
+            if (indexed && id > 0) {
+                index_insert(od->_str, len, id);
+            }
+        }
+        if (id > 0) {
+            /* new orders are usually read back soon */
+            cache_insert(id, od);
+        }
+        return id;
     }
     return 0;
 }
 
+void dblib_cache_stats(int *hits, int *misses)
+{
+    if (hits) *hits = g_cache_hits;
+    if (misses) *misses = g_cache_misses;
+}
+
+bool dblib_fork_begin(void)
+{
+    return db_driver_fork_begin();
+}
+
+void dblib_fork_child(void)
+{
+    db_driver_fork_child();
+}
+
 void dblib_open(void)
 {
+    g_cache_size = config_get_int("game.dbcache", 1 << 16);
+    if (g_cache_size > 0) {
+        g_cache = calloc(g_cache_size, sizeof(cache_entry));
+    }
+    g_cache_hits = g_cache_misses = 0;
     db_driver_open();
 }
 
 void dblib_close(void)
 {
+    if (g_cache_hits + g_cache_misses > 0) {
+        log_debug("order cache: %d hits, %d misses", g_cache_hits, g_cache_misses);
+    }
+    cache_clear();
+    cb_clear(&g_index);
     db_driver_close();
 }
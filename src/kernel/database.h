@@ -1,6 +1,7 @@
 #ifndef H_DATABASE
 #define H_DATABASE
 
+#include <stdbool.h>
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -14,6 +15,14 @@ extern "C" {
 
     struct order_data *dblib_load_order(int id);
     int dblib_save_order(struct order_data *od);
+    void dblib_cache_stats(int *hits, int *misses);
+
+    /* a forked child must not use the parent's database connection.
+     * dblib_fork_begin writes pending orders before fork, and returns false
+     * if a child cannot open the database again (a temporary database).
+     * dblib_fork_child opens a read-only connection in the child. */
+    bool dblib_fork_begin(void);
+    void dblib_fork_child(void);
 
 #ifdef __cplusplus
 }
@@ -7,6 +7,7 @@
 #include <CuTest.h>
 #include <tests.h>
 
+#include <stdio.h>
 #include <string.h>
 
 static void test_save_load_order(CuTest *tc) {
@@ -31,10 +32,136 @@ static void test_save_load_order(CuTest *tc) {
     test_cleanup();
 }
 
+static void test_load_order_cached(CuTest *tc) {
+    order_data *od;
+    int id, hits, n;
+    const char * s = "LERNE Hiebwaffen";
+
+    test_setup();
+
+    odata_create(&od, strlen(s) + 1, s);
+    id = odata_save(od);
+    odata_release(od);
+    CuAssertTrue(tc, id != 0);
+
+    dblib_cache_stats(&hits, NULL);
+    od = odata_load(id);
+    CuAssertPtrNotNull(tc, od);
+    CuAssertStrEquals(tc, s, od->_str);
+    odata_release(od);
+    od = odata_load(id);
+    CuAssertPtrNotNull(tc, od);
+    CuAssertStrEquals(tc, s, od->_str);
+    odata_release(od);
+    dblib_cache_stats(&n, NULL);
+    CuAssertIntEquals(tc, hits + 2, n);
+
+    test_cleanup();
+}
+
+static void test_save_order_shared(CuTest *tc) {
+    order_data *od;
+    int id1, id2;
+    const char * s = "BEWACHE";
+    const char * s2 = "ARBEITE";
+
+    test_setup();
+
+    odata_create(&od, strlen(s) + 1, s);
+    id1 = odata_save(od);
+    odata_release(od);
+    odata_create(&od, strlen(s) + 1, s);
+    id2 = odata_save(od);
+    odata_release(od);
+    CuAssertTrue(tc, id1 != 0);
+    CuAssertIntEquals(tc, id1, id2);
+
+    odata_create(&od, strlen(s2) + 1, s2);
+    id2 = odata_save(od);
+    odata_release(od);
+    CuAssertTrue(tc, id1 != id2);
+
+    test_cleanup();
+}
+
+/* reopen the database with the current configuration */
+static void db_reopen(void) {
+    dblib_close();
+    dblib_open();
+}
+
+static void test_save_orders_batch(CuTest *tc) {
+    order_data *od;
+    int i, ids[5];
+    char orders[5][16];
+
+    test_setup();
+    /* without the cache, every load is done by the driver */
+    config_set("game.dbcache", "0");
+    config_set("game.dbbatch", "2");
+    db_reopen();
+
+    for (i = 0; i != 5; ++i) {
+        sprintf(orders[i], "ARBEITE %d", i);
+        odata_create(&od, strlen(orders[i]) + 1, orders[i]);
+        ids[i] = odata_save(od);
+        odata_release(od);
+        CuAssertTrue(tc, ids[i] > 0);
+    }
+    /* the first four are written, the last is still pending */
+    for (i = 0; i != 5; ++i) {
+        od = odata_load(ids[i]);
+        CuAssertPtrNotNull(tc, od);
+        CuAssertStrEquals(tc, orders[i], od->_str);
+        odata_release(od);
+    }
+
+    test_cleanup();
+    db_reopen();
+}
+
+#ifdef USE_SQLITE
+static void test_reopen_database(CuTest *tc) {
+    order_data *od;
+    int id1, id2;
+    const char *s1 = "LERNE Magie";
+    const char *s2 = "LERNE Taktik";
+
+    test_setup();
+    config_set("game.dbname", "test_orders.db");
+    remove("test_orders.db");
+    db_reopen();
+    odata_create(&od, strlen(s1) + 1, s1);
+    id1 = odata_save(od);
+    odata_release(od);
+
+    /* pending orders are written when the database is closed */
+    db_reopen();
+    od = odata_load(id1);
+    CuAssertPtrNotNull(tc, od);
+    CuAssertStrEquals(tc, s1, od->_str);
+    odata_release(od);
+    odata_create(&od, strlen(s2) + 1, s2);
+    id2 = odata_save(od);
+    odata_release(od);
+    CuAssertTrue(tc, id2 > id1);
+
+    test_cleanup();
+    db_reopen();
+    CuAssertIntEquals(tc, 0, remove("test_orders.db"));
+}
+#endif
+
 CuSuite *get_db_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
     SUITE_ADD_TEST(suite, test_save_load_order);
+    SUITE_ADD_TEST(suite, test_load_order_cached);
+    SUITE_ADD_TEST(suite, test_save_order_shared);
+    SUITE_ADD_TEST(suite, test_save_orders_batch);
+#ifdef USE_SQLITE
+    SUITE_ADD_TEST(suite, test_reopen_database);
+#endif
 
     return suite;
 }
@@ -26,6 +26,26 @@ void db_driver_open(void)
     assert(ret==0);
 }
 
+bool db_driver_fork_begin(void)
+{
+    int ret = g_dbp->sync(g_dbp, 0);
+    assert(ret == 0);
+    return config_get("game.dbname") != NULL;
+}
+
+void db_driver_fork_child(void)
+{
+    int ret;
+    const char * dbname = config_get("game.dbname");
+
+    /* the parent's handle stays untouched, the child opens its own */
+    g_dbp = NULL;
+    ret = db_create(&g_dbp, NULL, 0);
+    assert(ret == 0);
+    ret = g_dbp->open(g_dbp, NULL, dbname, NULL, DB_RECNO, DB_RDONLY, 0);
+    assert(ret == 0);
+}
+
 void db_driver_close(void)
 {
     int ret;
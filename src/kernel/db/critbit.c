@@ -59,6 +59,16 @@ void db_driver_open(void)
     auto_id = 0;
 }
 
+bool db_driver_fork_begin(void)
+{
+    /* the orders are in memory, a child has its own copy */
+    return true;
+}
+
+void db_driver_fork_child(void)
+{
+}
+
 void db_driver_close(void)
 {
     cb_foreach(&cb_orders, NULL, 0, free_data_cb, NULL);
@@ -19,18 +19,53 @@ static sqlite3 *g_db;
 static sqlite3_stmt * g_stmt_insert;
 static sqlite3_stmt * g_stmt_select;
 
+/* orders are given their id when they are saved, but only written to
+ * the database in batches of g_order_batchsize rows per transaction.
+ * until then, they are kept in g_pending. game.dbbatch=0 (or 1) writes
+ * every order when it is saved, like the autocommit it replaced. */
 static int g_order_batchsize;
-static int g_order_tx_size;
+static int g_last_id;
+static order_data **g_pending;
+static int g_pending_size;
+
+static void db_flush_orders(void)
+{
+    if (g_pending_size > 0) {
+        int i, err, id = g_last_id - g_pending_size;
+
+        err = sqlite3_exec(g_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
+        assert(err == SQLITE_OK);
+        for (i = 0; i != g_pending_size; ++i) {
+            order_data *od = g_pending[i];
+            err = sqlite3_reset(g_stmt_insert);
+            assert(err == SQLITE_OK);
+            err = sqlite3_bind_int(g_stmt_insert, 1, ++id);
+            assert(err == SQLITE_OK);
+            err = sqlite3_bind_text(g_stmt_insert, 2, od->_str, -1, SQLITE_STATIC);
+            assert(err == SQLITE_OK);
+            err = sqlite3_step(g_stmt_insert);
+            assert(err == SQLITE_DONE);
+            odata_release(od);
+            g_pending[i] = NULL;
+        }
+        err = sqlite3_exec(g_db, "COMMIT", NULL, NULL, NULL);
+        assert(err == SQLITE_OK);
+        g_pending_size = 0;
+    }
+}
 
 order_data *db_driver_order_load(int id)
 {
     order_data * od = NULL;
     int err;
-    
-    if (g_order_tx_size > 0) {
-        g_order_tx_size = 0;
-        err = sqlite3_exec(g_db, "COMMIT", NULL, NULL, NULL);
-        assert(err == SQLITE_OK);
+
+    if (id > g_last_id - g_pending_size) {
+        /* not written to the database yet */
+        if (id <= g_last_id) {
+            od = g_pending[id - (g_last_id - g_pending_size) - 1];
+            odata_addref(od);
+        }
+        return od;
     }
     err = sqlite3_reset(g_stmt_select);
     assert(err == SQLITE_OK);
@@ -54,44 +89,31 @@ order_data *db_driver_order_load(int id)
 
 int db_driver_order_save(order_data *od)
 {
-    int err;
-    sqlite3_int64 id;
-    
     assert(od && od->_str);
-    
-    if (g_order_batchsize > 0) {
-        if (g_order_tx_size == 0) {
-            err = sqlite3_exec(g_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
-            assert(err == SQLITE_OK);
-        }
-    }
-    
-    err = sqlite3_reset(g_stmt_insert);
-    assert(err == SQLITE_OK);
-    err = sqlite3_bind_text(g_stmt_insert, 1, od->_str, -1, SQLITE_STATIC);
-    assert(err == SQLITE_OK);
-    err = sqlite3_step(g_stmt_insert);
-    assert(err == SQLITE_DONE);
-    id = sqlite3_last_insert_rowid(g_db);
-    assert(id <= INT_MAX);
-    
-    if (g_order_batchsize > 0) {
-        if (++g_order_tx_size >= g_order_batchsize) {
-            err = sqlite3_exec(g_db, "COMMIT", NULL, NULL, NULL);
-            assert(err == SQLITE_OK);
-            g_order_tx_size = 0;
-        }
+    assert(g_stmt_insert || !"the database is read-only in a forked child");
+    assert(g_last_id < INT_MAX);
+
+    odata_addref(od);
+    g_pending[g_pending_size++] = od;
+    ++g_last_id;
+    if (g_pending_size == g_order_batchsize) {
+        db_flush_orders();
     }
-    
-    return (int)id;
+    return g_last_id;
 }
 
 void db_driver_open(void)
 {
     int err;
     const char *dbname;
+    sqlite3_stmt *stmt;
 
-    g_order_batchsize = config_get_int("game.dbbatch", 100);
+    g_order_batchsize = config_get_int("game.dbbatch", 1000);
+    if (g_order_batchsize < 1) {
+        g_order_batchsize = 1;
+    }
+    g_pending = calloc(g_order_batchsize, sizeof(order_data *));
+    g_pending_size = 0;
     dbname = config_get("game.dbname");
     if (!dbname) {
         dbname = "";
@@ -104,7 +126,39 @@ void db_driver_open(void)
     assert(err == SQLITE_OK);
     err = sqlite3_exec(g_db, "CREATE TABLE IF NOT EXISTS orders (id INTEGER PRIMARY KEY, data TEXT NOT NULL)", NULL, NULL, NULL);
     assert(err == SQLITE_OK);
-    err = sqlite3_prepare_v2(g_db, "INSERT INTO orders (data) VALUES (?)", -1, &g_stmt_insert, NULL);
+    err = sqlite3_prepare_v2(g_db, "INSERT INTO orders (id, data) VALUES (?, ?)", -1, &g_stmt_insert, NULL);
+    assert(err == SQLITE_OK);
+    err = sqlite3_prepare_v2(g_db, "SELECT data FROM orders WHERE id = ?", -1, &g_stmt_select, NULL);
+    assert(err == SQLITE_OK);
+    err = sqlite3_prepare_v2(g_db, "SELECT MAX(id) FROM orders", -1, &stmt, NULL);
+    assert(err == SQLITE_OK);
+    err = sqlite3_step(stmt);
+    assert(err == SQLITE_ROW);
+    g_last_id = sqlite3_column_int(stmt, 0);
+    err = sqlite3_finalize(stmt);
+    assert(err == SQLITE_OK);
+}
+
+bool db_driver_fork_begin(void)
+{
+    const char *dbname = config_get("game.dbname");
+
+    db_flush_orders();
+    /* a temporary database is private to the connection that made it */
+    return dbname && dbname[0] && strcmp(dbname, ":memory:") != 0;
+}
+
+void db_driver_fork_child(void)
+{
+    int err;
+
+    /* SQLite connections must not be used on both sides of a fork, so the
+     * child leaves the parent's connection alone and opens one of its own */
+    assert(g_pending_size == 0);
+    g_stmt_select = NULL;
+    g_stmt_insert = NULL;
+    g_db = NULL;
+    err = sqlite3_open_v2(config_get("game.dbname"), &g_db, SQLITE_OPEN_READONLY, NULL);
     assert(err == SQLITE_OK);
     err = sqlite3_prepare_v2(g_db, "SELECT data FROM orders WHERE id = ?", -1, &g_stmt_select, NULL);
     assert(err == SQLITE_OK);
@@ -114,6 +168,10 @@ void db_driver_close(void)
 {
     int err;
 
+    db_flush_orders();
+    free(g_pending);
+    g_pending = NULL;
+
     err = sqlite3_finalize(g_stmt_select);
     assert(err == SQLITE_OK);
     err = sqlite3_finalize(g_stmt_insert);
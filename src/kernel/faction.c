@@ -102,6 +102,8 @@ static void free_faction(faction * f)
     free(f->banner);
     free(f->_password);
     free(f->name);
+    selist_free(f->regions);
+    f->regions = NULL;
     if (f->seen_factions) {
         selist_free(f->seen_factions);
         f->seen_factions = 0;
@@ -513,6 +515,14 @@ void renumber_faction(faction * f, int no)
     fhash(f);
 }
 
+static int cmp_region_index(const void *lhs, const void *rhs)
+{
+    const region *a = (const region *)lhs;
+    const region *b = (const region *)rhs;
+    if (a->index == b->index) return 0;
+    return (a->index < b->index) ? -1 : 1;
+}
+
 void update_interval(struct faction *f, struct region *r)
 {
     if (r == NULL || f == NULL)
@@ -523,6 +533,7 @@ void update_interval(struct faction *f, struct region *r)
     if (f->last == NULL || f->last->index <= r->index) {
         f->last = r;
     }
+    selist_set_insert(&f->regions, r, cmp_region_index);
 }
 
 const char *faction_getname(const faction * self)
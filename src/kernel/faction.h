@@ -97,6 +97,7 @@ extern "C" {
         } *battles;
         struct item *items;         /* items this faction can claim */
         struct selist *seen_factions;
+        struct selist *regions; /* with units, observers or travel of this faction, by index */
         bool _alive;              /* enno: sollte ein flag werden */
     } faction;
 
@@ -217,7 +217,7 @@ void write_groups(struct storage *store, const faction * f)
             }
         }
         write_faction_reference(NULL, store);
-        a_write(store, g->attribs, g);
+        write_attribs(store, g->attribs, g);
         WRITE_SECTION(store);
     }
     WRITE_INT(store, 0);
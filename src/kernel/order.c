@@ -41,7 +41,8 @@ void replace_order(order ** dlist, order * orig, const order * src)
     assert(dlist);
     while (*dlist != NULL) {
         order *dst = *dlist;
-        if (dst->id == orig->id) {
+        /* identical texts share an id, so the keyword must match, too */
+        if (dst->id == orig->id && dst->command == orig->command) {
             order *cpy = copy_order(src);
             *dlist = cpy;
             cpy->next = dst->next;
@@ -274,38 +275,45 @@ order *create_order(keyword_t kwd, const struct locale * lang,
     return ord;
 }
 
+order *parse_order_ex(const char *token, const char *sptr, const struct locale * lang)
+{
+    keyword_t kwd = NOKEYWORD;
+    bool persistent = false, noerror = false;
+    const char * p = token;
+
+    assert(lang);
+    if (p) {
+        while (*p == '!' || *p == '@') {
+            if (*p == '!') noerror = true;
+            else if (*p == '@') persistent = true;
+            ++p;
+        }
+        kwd = get_keyword(p, lang);
+    }
+    if (kwd == K_MAKE) {
+        const char *sp = sptr;
+        p = parse_token_depr(&sp);
+        if (p && isparam(p, lang, P_TEMP)) {
+            kwd = K_MAKETEMP;
+            sptr = sp;
+        }
+    }
+    if (kwd != NOKEYWORD) {
+        order *ord = (order *)malloc(sizeof(order));
+        create_order_i(ord, kwd, sptr, persistent, noerror, lang);
+        return ord;
+    }
+    return NULL;
+}
+
 order *parse_order(const char *s, const struct locale * lang)
 {
     assert(lang);
     assert(s);
     if (*s != 0) {
-        keyword_t kwd = NOKEYWORD;
         const char *sptr = s;
-        bool persistent = false, noerror = false;
-        const char * p;
-
-        p = *sptr ? parse_token_depr(&sptr) : 0;
-        if (p) {
-            while (*p == '!' || *p == '@') {
-                if (*p == '!') noerror = true;
-                else if (*p == '@') persistent = true;
-                ++p;
-            }
-            kwd = get_keyword(p, lang);
-        }
-        if (kwd == K_MAKE) {
-            const char *sp = sptr;
-            p = parse_token_depr(&sp);
-            if (p && isparam(p, lang, P_TEMP)) {
-                kwd = K_MAKETEMP;
-                sptr = sp;
-            }
-        }
-        if (kwd != NOKEYWORD) {
-            order *ord = (order *)malloc(sizeof(order));
-            create_order_i(ord, kwd, sptr, persistent, noerror, lang);
-            return ord;
-        }
+        const char *p = parse_token_depr(&sptr);
+        return parse_order_ex(p, sptr, lang);
     }
     return NULL;
 }
@@ -481,6 +489,42 @@ char *write_order(const order * ord, const struct locale *lang, char *buffer, si
     return buffer;
 }
 
+int get_order_flags(const order *ord)
+{
+    return ord->command & ~0xFFFF;
+}
+
+char *get_order_args(const order *ord, const struct locale *lang, char *buffer, size_t size)
+{
+    if (ord->id < 0) {
+        skill_t sk = (skill_t)(100 + ord->id);
+        assert(ORD_KEYWORD(ord) == K_STUDY && sk < MAXSKILLS);
+        strlcpy(buffer, skillname(sk, lang), size);
+    }
+    else if (ord->id > 0) {
+        order_data *od = odata_load(ord->id);
+        const char *text = OD_STRING(od);
+        strlcpy(buffer, text ? text : "", size);
+        odata_release(od);
+    }
+    else if (size > 0) {
+        buffer[0] = 0;
+    }
+    return buffer;
+}
+
+order *create_order_ex(keyword_t kwd, int flags, const char *args, const struct locale *lang)
+{
+    order *ord;
+
+    if (kwd == NOKEYWORD || keyword_disabled(kwd)) {
+        return NULL;
+    }
+    ord = (order *)malloc(sizeof(order));
+    create_order_i(ord, kwd, args, (flags & CMD_PERSIST) != 0, (flags & CMD_QUIET) != 0, lang);
+    return ord;
+}
+
 void push_order(order ** ordp, order * ord)
 {
     while (*ordp)
@@ -488,22 +532,16 @@ void push_order(order ** ordp, order * ord)
     *ordp = ord;
 }
 
-static order_data *parser_od;
-
+/* the global parser holds the reference to the order_data, and releases
+ * it when it is initialized again */
 keyword_t init_order(const struct order *ord, const struct locale *lang)
 {
     if (!ord) {
-        odata_release(parser_od);
-        parser_od = NULL;
+        init_tokens_str(NULL);
         return NOKEYWORD;
     }
     else {
         keyword_t kwd = ORD_KEYWORD(ord);
-        if (parser_od) {
-            /* TODO: warning */
-            odata_release(parser_od);
-            parser_od = NULL;
-        }
         if (ord->id < 0) {
             skill_t sk = (skill_t)(100 + ord->id);
             assert(sk < MAXSKILLS);
@@ -512,18 +550,44 @@ keyword_t init_order(const struct order *ord, const struct locale *lang)
             init_tokens_str(skillname(sk, lang));
         }
         else {
-            const char *str;
-            parser_od = odata_load(ord->id);
-            if (parser_od) {
-                odata_addref(parser_od);
+            order_data *od = odata_load(ord->id);
+            if (od) {
+                int ntokens;
+                const char *tokens = odata_tokens(od, &ntokens);
+                init_tokens_parsed(tokens, ntokens, od, (void(*)(void *))odata_release);
+            }
+            else {
+                init_tokens_str(NULL);
             }
-            str = OD_STRING(parser_od);
-            init_tokens_ex(str, parser_od, (void(*)(void *))odata_release);
         }
         return kwd;
     }
 }
 
+keyword_t init_order_ex(struct parser_state *ps, const struct order *ord, const struct locale *lang)
+{
+    keyword_t kwd = ORD_KEYWORD(ord);
+    if (ord->id < 0) {
+        skill_t sk = (skill_t)(100 + ord->id);
+        assert(sk < MAXSKILLS);
+        assert(lang);
+        assert(kwd == K_STUDY);
+        parser_init(ps, skillname(sk, lang), NULL, NULL);
+    }
+    else {
+        order_data *od = odata_load(ord->id);
+        if (od) {
+            int ntokens;
+            const char *tokens = odata_tokens(od, &ntokens);
+            parser_init_tokens(ps, tokens, ntokens, od, (void(*)(void *))odata_release);
+        }
+        else {
+            parser_init(ps, NULL, NULL, NULL);
+        }
+    }
+    return kwd;
+}
+
 keyword_t init_order_depr(const struct order *ord)
 {
     if (ord) {
@@ -534,8 +598,6 @@ keyword_t init_order_depr(const struct order *ord)
 }
 
 void close_orders(void) {
-    if (parser_od) {
-        (void)init_order(NULL, NULL);
-    }
+    (void)init_order(NULL, NULL);
 }
 
@@ -22,14 +22,15 @@ extern "C" {
 #endif
 
     struct locale;
+    struct parser_state;
 
     /* Encapsulation of an order
      *
      * This structure contains one order given by a unit. These used to be
      * stored in string lists, but by storing them in order-structures,
      * it is possible to use reference-counting on them, reduce string copies,
-     * and reduce overall memory usage by sharing strings between orders (not
-     * implemented yet) saving approx. 50% of all string-related memory.
+     * and reduce overall memory usage by sharing strings between orders.
+     * Orders with identical text share the same id in the order database.
      */
 
 #define CMD_QUIET   0x010000
@@ -47,6 +48,9 @@ extern "C" {
     order *create_order(keyword_t kwd, const struct locale *lang,
         const char *params, ...);
     order *parse_order(const char *s, const struct locale *lang);
+    /* like parse_order, for a line that is already split into its first
+     * token and the rest of the line. */
+    order *parse_order_ex(const char *token, const char *rest, const struct locale *lang);
     void replace_order(order ** dst, order * orig, const order * src);
 
     /* reference counted copies of orders: */
@@ -69,8 +73,17 @@ extern "C" {
 
     char *write_order(const order * ord, const struct locale *lang,
         char *buffer, size_t size);
+    /* the parts of an order that the datafile stores, and the inverse */
+    int get_order_flags(const order *ord);
+    char *get_order_args(const order *ord, const struct locale *lang,
+        char *buffer, size_t size);
+    order *create_order_ex(keyword_t kwd, int flags, const char *args,
+        const struct locale *lang);
     keyword_t init_order_depr(const struct order *ord);
     keyword_t init_order(const struct order *ord, const struct locale *lang);
+    /* like init_order, but with a private parser state. call parser_done
+     * on ps when finished. */
+    keyword_t init_order_ex(struct parser_state *ps, const struct order *ord, const struct locale *lang);
 
     void close_orders(void);
 
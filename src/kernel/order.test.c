@@ -4,6 +4,7 @@
 
 #include <kernel/skills.h>
 
+#include <util/base36.h>
 #include <util/parser.h>
 #include <util/language.h>
 
@@ -187,6 +188,26 @@ static void test_skip_token(CuTest *tc) {
     CuAssertStrEquals(tc, 0, getstrtoken());
 }
 
+static void test_init_order_ex(CuTest *tc) {
+    order *ord;
+    struct locale * lang;
+    parser_state ps;
+    char token[32];
+
+    test_setup();
+    lang = test_create_locale();
+    ord = create_order(K_GIVE, lang, "%s %d", "abc", 42);
+    CuAssertIntEquals(tc, K_GIVE, init_order_ex(&ps, ord, lang));
+    CuAssertIntEquals(tc, K_GIVE, init_order(ord, lang));
+    CuAssertIntEquals(tc, atoi36("abc"), parser_id(&ps));
+    CuAssertStrEquals(tc, "abc", gettoken(token, sizeof(token)));
+    CuAssertIntEquals(tc, 42, parser_int(&ps));
+    CuAssertTrue(tc, parser_eof(&ps));
+    parser_done(&ps);
+    free_order(ord);
+    test_cleanup();
+}
+
 static void test_replace_order(CuTest *tc) {
     order *orders = 0, *orig, *repl;
     struct locale * lang;
@@ -207,6 +228,27 @@ static void test_replace_order(CuTest *tc) {
     test_cleanup();
 }
 
+static void test_replace_order_same_text(CuTest *tc) {
+    order *orders = 0, *orig, *other, *repl;
+    struct locale * lang;
+
+    test_setup();
+    lang = test_create_locale();
+    other = create_order(K_MOVE, lang, "o w");
+    orig = create_order(K_ROUTE, lang, "o w");
+    CuAssertIntEquals(tc, other->id, orig->id);
+    repl = create_order(K_ROUTE, lang, "w o");
+    orders = other;
+    other->next = orig;
+    replace_order(&orders, orig, repl);
+    CuAssertPtrEquals(tc, other, orders);
+    CuAssertPtrNotNull(tc, orders->next);
+    CuAssertIntEquals(tc, repl->id, orders->next->id);
+    free_orders(&orders);
+    free_order(repl);
+    test_cleanup();
+}
+
 static void test_get_command(CuTest *tc) {
     struct locale * lang;
     order *ord;
@@ -341,7 +383,9 @@ CuSuite *get_order_suite(void)
     SUITE_ADD_TEST(suite, test_parse_make_temp);
     SUITE_ADD_TEST(suite, test_parse_maketemp);
     SUITE_ADD_TEST(suite, test_init_order);
+    SUITE_ADD_TEST(suite, test_init_order_ex);
     SUITE_ADD_TEST(suite, test_replace_order);
+    SUITE_ADD_TEST(suite, test_replace_order_same_text);
     SUITE_ADD_TEST(suite, test_skip_token);
     SUITE_ADD_TEST(suite, test_getstrtoken);
     SUITE_ADD_TEST(suite, test_get_command);
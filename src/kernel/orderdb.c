@@ -3,6 +3,7 @@
 #include "orderdb.h"
 
 #include <util/log.h>
+#include <util/parser.h>
 
 #include <critbit.h>
 
@@ -16,6 +17,8 @@ void odata_create(order_data **pdata, size_t len, const char *str)
 
     data = malloc(sizeof(order_data) + len + 1);
     data->_refcount = 1;
+    data->_tokens = NULL;
+    data->_ntokens = 0;
     result = (char *)(data + 1);
     data->_str = (len > 0) ? result : NULL;
     if (str) strcpy(result, str);
@@ -26,6 +29,7 @@ void odata_release(order_data * od)
 {
     if (od) {
         if (--od->_refcount == 0) {
+            free(od->_tokens);
             free(od);
         }
     }
@@ -36,6 +40,31 @@ void odata_addref(order_data *od)
     ++od->_refcount;
 }
 
+/* split the order text into tokens once, so that parsing the same order
+ * again does not need to scan the text. this changes od on first use, so
+ * code that shares an order_data between threads must call it first. */
+const char *odata_tokens(order_data *od, int *ntokens)
+{
+    if (od->_tokens == NULL && od->_str) {
+        const char *str = od->_str;
+        /* a token is never longer than the text it was parsed from */
+        size_t size = strlen(str) + 2;
+        char *cursor = od->_tokens = malloc(size);
+        for (;;) {
+            const char *next = str;
+            if (!parse_token(&next, cursor, size) || next == str) {
+                break;
+            }
+            str = next;
+            size -= strlen(cursor) + 1;
+            cursor += strlen(cursor) + 1;
+            ++od->_ntokens;
+        }
+    }
+    if (ntokens) *ntokens = od->_ntokens;
+    return od->_tokens;
+}
+
 order_data *odata_load(int id)
 {
     return dblib_load_order(id);
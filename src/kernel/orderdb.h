@@ -10,11 +10,15 @@ extern "C" {
     typedef struct order_data {
         const char *_str;
         int _refcount;
+        /* tokens of _str, separated by NUL, created by odata_tokens */
+        char *_tokens;
+        int _ntokens;
     } order_data;
 
     void odata_create(order_data **pdata, size_t len, const char *str);
     void odata_release(order_data * od);
     void odata_addref(order_data *od);
+    const char *odata_tokens(order_data *od, int *ntokens);
 
     order_data *odata_load(int id);
     int odata_save(order_data *od);
@@ -19,10 +19,33 @@ static void test_orderdb(CuTest *tc) {
     odata_release(od);
 }
 
+static void test_odata_tokens(CuTest *tc) {
+    order_data *od = NULL;
+    const char * s = "GIB 'enno s' 1 Hodor~Hodor";
+    const char *tokens;
+    int ntokens;
+
+    odata_create(&od, strlen(s) + 1, s);
+    /* tokens are made when the order is first parsed */
+    CuAssertPtrEquals(tc, NULL, od->_tokens);
+    tokens = odata_tokens(od, &ntokens);
+    CuAssertIntEquals(tc, 4, ntokens);
+    CuAssertStrEquals(tc, "GIB", tokens);
+    tokens += strlen(tokens) + 1;
+    CuAssertStrEquals(tc, "enno s", tokens);
+    tokens += strlen(tokens) + 1;
+    CuAssertStrEquals(tc, "1", tokens);
+    tokens += strlen(tokens) + 1;
+    CuAssertStrEquals(tc, "Hodor Hodor", tokens);
+    CuAssertPtrEquals(tc, (void *)od->_tokens, (void *)odata_tokens(od, NULL));
+    odata_release(od);
+}
+
 CuSuite *get_orderdb_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
     SUITE_ADD_TEST(suite, test_orderdb);
+    SUITE_ADD_TEST(suite, test_odata_tokens);
 
     return suite;
 }
@@ -26,6 +26,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include "ally.h"
 #include "building.h"
 #include "connection.h"
+#include "database.h"
 #include "equipment.h"
 #include "faction.h"
 #include "group.h"
@@ -65,6 +66,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <util/gamedata.h>
 #include <util/goodies.h>
 #include <util/gamedata.h>
+#include <util/gzstream.h>
 #include <util/language.h>
 #include <util/lists.h>
 #include <util/log.h>
@@ -89,6 +91,12 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <stdlib.h>
 #include <ctype.h>
 #include <assert.h>
+#include <time.h>
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #define xisdigit(c)     (((c) >= '0' && (c) <= '9') || (c) == '-')
 
@@ -276,7 +284,7 @@ void write_planes(storage *store) {
 #if RELEASE_VERSION < NOWATCH_VERSION
         write_faction_reference(NULL, store);  /* mark the end of pl->watchers (gone since T966)  */
 #endif
-        a_write(store, pl->attribs, pl);
+        write_attribs(store, pl->attribs, pl);
         WRITE_SECTION(store);
     }
 }
@@ -378,10 +386,34 @@ int current_turn(void)
 static void writeorder(gamedata *data, const struct order *ord,
     const struct locale *lang)
 {
-    char obuf[1024];
-    write_order(ord, lang, obuf, sizeof(obuf));
-    if (obuf[0])
-        WRITE_STR(data->store, obuf);
+    keyword_t kwd = getkeyword(ord);
+    /* the keyword of K_END is the end of the order list */
+    if (kwd != NOKEYWORD && kwd != K_END) {
+        char obuf[DISPLAYSIZE];
+        const char *args = get_order_args(ord, lang, obuf, sizeof(obuf));
+        if (strlen(args) + 1 >= sizeof(obuf)) {
+            log_warning("arguments of order '%s' are cut to %d bytes", keyword(kwd), (int)sizeof(obuf) - 1);
+        }
+        WRITE_TOK(data->store, keyword(kwd));
+        WRITE_INT(data->store, get_order_flags(ord));
+        WRITE_STR(data->store, args);
+    }
+}
+
+static order *readorder(gamedata *data, const char *name,
+    const struct locale *lang)
+{
+    char obuf[DISPLAYSIZE];
+    keyword_t kwd = findkeyword(name);
+    int flags;
+
+    READ_INT(data->store, &flags);
+    READ_STR(data->store, obuf, sizeof(obuf));
+    if (kwd == NOKEYWORD) {
+        log_error("unknown keyword '%s' in order", name);
+        return NULL;
+    }
+    return create_order_ex(kwd, flags, obuf, lang);
 }
 
 static void read_skills(gamedata *data, unit *u)
@@ -548,11 +580,24 @@ unit *read_unit(gamedata *data)
     }
     /* Persistente Befehle einlesen */
     free_orders(&u->orders);
-    READ_STR(data->store, obuf, sizeof(obuf));
     p = n = 0;
     orderp = &u->orders;
-    while (obuf[0]) {
-        order *ord = parse_order(obuf, u->faction->locale);
+    for (;;) {
+        order *ord;
+        if (data->version < ORDERDATA_VERSION) {
+            READ_STR(data->store, obuf, sizeof(obuf));
+            if (!obuf[0]) break;
+            ord = parse_order(obuf, u->faction->locale);
+        }
+        else {
+            READ_TOK(data->store, obuf, sizeof(obuf));
+            if (strcmp(obuf, "end") == 0) break;
+            if (!obuf[0]) {
+                log_error("order list of %s is not terminated", itoa36(u->no));
+                break;
+            }
+            ord = readorder(data, obuf, u->faction->locale);
+        }
         if (ord != NULL) {
             if (++n < MAXORDERS) {
                 if (!is_persistent(ord) || ++p < MAXPERSISTENT) {
@@ -571,7 +616,6 @@ unit *read_unit(gamedata *data)
                 free_order(ord);
             }
         }
-        READ_STR(data->store, obuf, sizeof(obuf));
     }
     set_order(&u->thisorder, NULL);
 
@@ -634,8 +678,7 @@ void write_unit(gamedata *data, const unit * u)
             }
         }
     }
-    /* write an empty string to terminate the list */
-    WRITE_STR(data->store, "");
+    WRITE_TOK(data->store, "end");
     WRITE_SECTION(data->store);
 
     assert(u_race(u));
@@ -1213,6 +1256,49 @@ static int cb_sb_maxlevel(spellbook_entry *sbe, void *cbdata) {
     return 0;
 }
 
+/* file positions in the index are 64 bit, also where long is not */
+#ifdef WIN32
+#define index_tell(F) _ftelli64(F)
+#define index_seek(F, pos, whence) _fseeki64(F, pos, whence)
+#else
+#define index_tell(F) ((long long)ftello(F))
+#define index_seek(F, pos, whence) fseeko(F, (off_t)(pos), whence)
+#endif
+
+/* binstore reads and writes a few bytes at a time, a large stdio buffer
+ * saves most of the system calls when streaming a whole datafile. */
+#define DATAFILE_BUFSIZE (1 << 20)
+
+static FILE *open_datafile(const char *path, const char *mode)
+{
+    FILE *F = fopen(path, mode);
+    if (F) {
+        /* game.iobuffer is in KB, 0 keeps the stdio default */
+        int kb = config_get_int("game.iobuffer", DATAFILE_BUFSIZE >> 10);
+        if (kb > 0) {
+            setvbuf(F, NULL, _IOFBF, (size_t)kb << 10);
+        }
+    }
+    return F;
+}
+
+/* returns -1 if reading or writing F failed */
+static int close_datafile(stream *strm, FILE *F)
+{
+    int err = 0;
+#ifdef USE_ZLIB
+    if (gzstream_check(strm)) {
+        return gzstream_done(strm);
+    }
+#endif
+    if (fflush(F) != 0 || ferror(F)) {
+        log_error("datafile I/O error: %s", strerror(errno));
+        err = -1;
+    }
+    fstream_done(strm);
+    return err;
+}
+
 int readgame(const char *filename)
 {
     int n, stream_version;
@@ -1222,22 +1308,34 @@ int readgame(const char *filename)
     stream strm;
     FILE *F;
     size_t sz;
+    clock_t start = clock();
 
     log_debug("- reading game data from %s", filename);
     join_path(datapath(), filename, path, sizeof(path));
 
-    F = fopen(path, "rb");
+    F = open_datafile(path, "rb");
     if (!F) {
         perror(path);
         return -1;
     }
     sz = fread(&gdata.version, sizeof(int), 1, F);
     sz = fread(&stream_version, sizeof(int), 1, F);
-    assert((sz == 1 && stream_version == STREAM_VERSION) || !"unsupported data format");
+    assert((sz == 1 && (stream_version & ~STREAM_ZLIB) == STREAM_VERSION) || !"unsupported data format");
     assert(gdata.version >= MIN_VERSION || !"unsupported data format");
     assert(gdata.version <= MAX_VERSION || !"unsupported data format");
 
-    fstream_init(&strm, F);
+    if (stream_version & STREAM_ZLIB) {
+#ifdef USE_ZLIB
+        gzstream_init(&strm, F, "rb", 0);
+#else
+        log_error("%s is compressed, but zlib support is not compiled in", filename);
+        fclose(F);
+        return -1;
+#endif
+    }
+    else {
+        fstream_init(&strm, F);
+    }
     binstore_init(&store, &strm);
     gdata.store = &store;
 
@@ -1247,8 +1345,11 @@ int readgame(const char *filename)
         log_debug("data in %s created with build %d.", filename, build);
     }
     n = read_game(&gdata);
+    /* to compare buffer sizes and compression, see game.iobuffer */
+    log_info("read %lld bytes from %s in %.2f seconds", index_tell(F), filename,
+        (double)(clock() - start) / CLOCKS_PER_SEC);
     binstore_done(&store);
-    fstream_done(&strm);
+    close_datafile(&strm, F);
     return n;
 }
 
@@ -1432,18 +1533,9 @@ static void fix_familiars(void) {
     }
 }
 
-int read_game(gamedata *data)
+static void read_game_globals(gamedata *data)
 {
-    int p, nread;
-    faction *f, **fp;
-    region *r;
-    building **bp;
-    ship **shp;
-    unit *u;
-    int rmax = maxregions;
     storage * store = data->store;
-    const struct building_type *bt_lighthouse = bt_find("lighthouse");
-    const struct race *rc_spell = rc_find("spell");
 
     if (data->version >= SAVEGAMEID_VERSION) {
         int gameid;
@@ -1465,7 +1557,14 @@ int read_game(gamedata *data)
 
     read_planes(data);
     read_alliances(data);
-    READ_INT(store, &nread);
+}
+
+static void read_factions(gamedata *data)
+{
+    faction **fp;
+    int nread;
+
+    READ_INT(data->store, &nread);
     log_debug(" - Einzulesende Parteien: %d\n", nread);
     fp = &factions;
     while (*fp) {
@@ -1480,80 +1579,84 @@ int read_game(gamedata *data)
         fhash(f);
     }
     *fp = 0;
+}
 
-    /* Regionen */
-
-    READ_INT(store, &nread);
-    assert(nread < MAXREGIONS && nread>=0);
-    if (rmax < 0) {
-        rmax = nread;
-    }
-    log_debug(" - Einzulesende Regionen: %d/%d", rmax, nread);
-
-    while (--nread >= 0) {
-        unit **up;
+/* one region, with its buildings, ships and units */
+static region *read_region_block(gamedata *data, const struct building_type *bt_lighthouse, const struct race *rc_spell)
+{
+    storage * store = data->store;
+    building **bp;
+    ship **shp;
+    unit **up;
+    region *r;
+    int p;
 
-        r = read_region(data);
+    r = read_region(data);
 
-        /* Burgen */
-        READ_INT(store, &p);
-        if (p > 0 && !r->land) {
-            log_error("%s, uid=%d has %d buildings", regionname(r, NULL), r->uid, p);
-        }
-        bp = &r->buildings;
+    /* Burgen */
+    READ_INT(store, &p);
+    if (p > 0 && !r->land) {
+        log_error("%s, uid=%d has %d buildings", regionname(r, NULL), r->uid, p);
+    }
+    bp = &r->buildings;
 
-        while (--p >= 0) {
-            building *b = *bp = read_building(data);
-            if (b->type == bt_lighthouse) {
-                r->flags |= RF_LIGHTHOUSE;
-            }
-            b->region = r;
-            bp = &b->next;
+    while (--p >= 0) {
+        building *b = *bp = read_building(data);
+        if (b->type == bt_lighthouse) {
+            r->flags |= RF_LIGHTHOUSE;
         }
-        /* Schiffe */
+        b->region = r;
+        bp = &b->next;
+    }
+    /* Schiffe */
 
-        READ_INT(store, &p);
-        shp = &r->ships;
+    READ_INT(store, &p);
+    shp = &r->ships;
 
-        while (--p >= 0) {
-            ship *sh = *shp = read_ship(data);
-            sh->region = r;
-            shp = &sh->next;
-        }
+    while (--p >= 0) {
+        ship *sh = *shp = read_ship(data);
+        sh->region = r;
+        shp = &sh->next;
+    }
 
-        *shp = 0;
+    *shp = 0;
 
-        /* Einheiten */
+    /* Einheiten */
 
-        READ_INT(store, &p);
-        up = &r->units;
+    READ_INT(store, &p);
+    up = &r->units;
 
-        while (--p >= 0) {
-            unit *u = read_unit(data);
+    while (--p >= 0) {
+        unit *u = read_unit(data);
 
-            if (data->version < NORCSPELL_VERSION && u_race(u) == rc_spell) {
-                set_observer(r, u->faction, get_level(u, SK_PERCEPTION), u->age);
-                u_setfaction(u, NULL);
-                free_unit(u);
-            }
-            else {
-                if (data->version < JSON_REPORT_VERSION) {
-                    if (u->_name && fval(u->faction, FFL_NPC)) {
-                        if (!u->_name[0] || unit_name_equals_race(u)) {
-                            unit_setname(u, NULL);
-                        }
+        if (data->version < NORCSPELL_VERSION && u_race(u) == rc_spell) {
+            set_observer(r, u->faction, get_level(u, SK_PERCEPTION), u->age);
+            u_setfaction(u, NULL);
+            free_unit(u);
+        }
+        else {
+            if (data->version < JSON_REPORT_VERSION) {
+                if (u->_name && fval(u->faction, FFL_NPC)) {
+                    if (!u->_name[0] || unit_name_equals_race(u)) {
+                        unit_setname(u, NULL);
                     }
                 }
-                assert(u->region == NULL);
-                u->region = r;
-                *up = u;
-                up = &u->next;
-                update_interval(u->faction, r);
             }
+            assert(u->region == NULL);
+            u->region = r;
+            *up = u;
+            up = &u->next;
+            update_interval(u->faction, r);
         }
-        --rmax;
     }
-    read_borders(data);
+    return r;
+}
+
+static void read_game_done(gamedata *data)
+{
+    faction *f;
+    region *r;
+    unit *u;
 
     log_debug("updating area information for lighthouses.");
     for (r = regions; r; r = r->next) {
@@ -1617,7 +1720,34 @@ int read_game(gamedata *data)
         remove_empty_factions();
     }
     log_debug("Done loading turn %d.", turn);
+}
+
+int read_game(gamedata *data)
+{
+    int nread;
+    int rmax = maxregions;
+    storage * store = data->store;
+    const struct building_type *bt_lighthouse = bt_find("lighthouse");
+    const struct race *rc_spell = rc_find("spell");
 
+    read_game_globals(data);
+    read_factions(data);
+
+    /* Regionen */
+
+    READ_INT(store, &nread);
+    assert(nread < MAXREGIONS && nread>=0);
+    if (rmax < 0) {
+        rmax = nread;
+    }
+    log_debug(" - Einzulesende Regionen: %d/%d", rmax, nread);
+
+    while (--nread >= 0) {
+        read_region_block(data, bt_lighthouse, rc_spell);
+        --rmax;
+    }
+    read_borders(data);
+    read_game_done(data);
     return 0;
 }
 
@@ -1631,15 +1761,218 @@ static void clear_npc_orders(faction *f)
     }
 }
 
+#define INDEX_MAGIC 0x58444e49 /* "INDX" */
+
+/* the section index is appended to the datafile, after the borders.
+ * readers that do not know about it stop before it, so the datafile
+ * version does not change. offsets are stored as 64 bit values:
+ *   int nfactions, long long offset[nfactions],
+ *   int nregions, (int x, int y, long long offset)[nregions],
+ *   long long borders, long long start of the index, int INDEX_MAGIC
+ */
+static void write_index_offset(FILE *F, long long offset)
+{
+    fwrite(&offset, sizeof(offset), 1, F);
+}
+
+static void write_save_index(FILE *F, const save_index *index)
+{
+    long long start = index_tell(F);
+    int i, n = INDEX_MAGIC;
+
+    fwrite(&index->nfactions, sizeof(int), 1, F);
+    for (i = 0; i != index->nfactions; ++i) {
+        write_index_offset(F, index->factions[i]);
+    }
+    fwrite(&index->nregions, sizeof(int), 1, F);
+    for (i = 0; i != index->nregions; ++i) {
+        const save_index_region *ir = index->regions + i;
+        fwrite(&ir->x, sizeof(int), 1, F);
+        fwrite(&ir->y, sizeof(int), 1, F);
+        write_index_offset(F, ir->offset);
+    }
+    write_index_offset(F, index->borders);
+    write_index_offset(F, start);
+    fwrite(&n, sizeof(int), 1, F);
+}
+
+static bool read_index_offset(FILE *F, long long *offset)
+{
+    return fread(offset, sizeof(long long), 1, F) == 1;
+}
+
+static bool read_save_index_data(FILE *F, save_index *index)
+{
+    long long start;
+    int i, n;
+
+    if (fseek(F, -(long)(sizeof(long long) + sizeof(int)), SEEK_END) != 0
+        || !read_index_offset(F, &start)
+        || fread(&n, sizeof(int), 1, F) != 1 || n != INDEX_MAGIC
+        || index_seek(F, start, SEEK_SET) != 0) {
+        return false;
+    }
+    if (fread(&n, sizeof(int), 1, F) != 1 || n < 0) {
+        return false;
+    }
+    index->nfactions = n;
+    index->factions = malloc(sizeof(long long) * (n + 1));
+    for (i = 0; i != n; ++i) {
+        if (!read_index_offset(F, index->factions + i)) {
+            return false;
+        }
+    }
+    if (fread(&n, sizeof(int), 1, F) != 1 || n < 0) {
+        return false;
+    }
+    index->nregions = n;
+    index->regions = malloc(sizeof(save_index_region) * (n + 1));
+    for (i = 0; i != n; ++i) {
+        save_index_region *ir = index->regions + i;
+        if (fread(&ir->x, sizeof(int), 1, F) != 1
+            || fread(&ir->y, sizeof(int), 1, F) != 1
+            || !read_index_offset(F, &ir->offset)) {
+            return false;
+        }
+    }
+    return read_index_offset(F, &index->borders);
+}
+
+int read_save_index(const char *filename, save_index *index)
+{
+    char path[MAX_PATH];
+    FILE *F;
+    int err = 0;
+    int header[2];
+
+    memset(index, 0, sizeof(save_index));
+    join_path(datapath(), filename, path, sizeof(path));
+    F = fopen(path, "rb");
+    if (!F) {
+        return errno;
+    }
+    if (fread(header, sizeof(int), 2, F) != 2 || header[1] != STREAM_VERSION) {
+        /* compressed datafiles have no index */
+        err = ENOENT;
+    }
+    else if (!read_save_index_data(F, index)) {
+        free_save_index(index);
+        err = ENOENT;
+    }
+    fclose(F);
+    return err;
+}
+
+void free_save_index(save_index *index)
+{
+    free(index->factions);
+    free(index->regions);
+    memset(index, 0, sizeof(save_index));
+}
+
+int readgame_regions(const char *filename, const save_index *index, const int *regions, int nregions)
+{
+    int i, stream_version;
+    char path[MAX_PATH];
+    gamedata gdata = { 0 };
+    storage store;
+    stream strm;
+    FILE *F;
+    const struct building_type *bt_lighthouse = bt_find("lighthouse");
+    const struct race *rc_spell = rc_find("spell");
+
+    log_debug("- reading %d regions from %s", nregions, filename);
+    join_path(datapath(), filename, path, sizeof(path));
+
+    F = fopen(path, "rb");
+    if (!F) {
+        perror(path);
+        return -1;
+    }
+    if (fread(&gdata.version, sizeof(int), 1, F) != 1
+        || fread(&stream_version, sizeof(int), 1, F) != 1
+        || stream_version != STREAM_VERSION || gdata.version < MIN_VERSION || gdata.version > MAX_VERSION) {
+        log_error("unsupported data format in %s", filename);
+        fclose(F);
+        return -1;
+    }
+
+    fstream_init(&strm, F);
+    binstore_init(&store, &strm);
+    gdata.store = &store;
+
+    if (gdata.version >= BUILDNO_VERSION) {
+        READ_INT(&store, NULL);
+    }
+    read_game_globals(&gdata);
+    read_factions(&gdata);
+    for (i = 0; i != nregions; ++i) {
+        int n = regions[i];
+        assert(n >= 0 && n < index->nregions);
+        index_seek(F, index->regions[n].offset, SEEK_SET);
+        read_region_block(&gdata, bt_lighthouse, rc_spell);
+    }
+    read_game_done(&gdata);
+    if (ur_count() > 0) {
+        /* units, buildings and ships in the regions that were not read */
+        log_debug("- %d references to objects that were not read", ur_count());
+        ur_reset();
+    }
+    binstore_done(&store);
+    fstream_done(&strm);
+    return 0;
+}
+
+int readgame_area(const char *filename, int left, int bottom, int right, int top)
+{
+    save_index index;
+    int *regions;
+    int i, n = 0, err;
+
+    if (read_save_index(filename, &index) != 0) {
+        /* compressed datafiles, and those of older servers, have no index */
+        log_warning("%s has no section index, reading all regions", filename);
+        return readgame(filename);
+    }
+    regions = malloc(sizeof(int) * (index.nregions + 1));
+    for (i = 0; i != index.nregions; ++i) {
+        const save_index_region *ir = index.regions + i;
+        if (ir->x >= left && ir->x <= right && ir->y >= bottom && ir->y <= top) {
+            regions[n++] = i;
+        }
+    }
+    err = readgame_regions(filename, &index, regions, n);
+    free(regions);
+    free_save_index(&index);
+    return err;
+}
+
+static void index_section(FILE *F, long long *offset)
+{
+    if (F) {
+        *offset = index_tell(F);
+    }
+}
+
+static int write_game_sections(gamedata *data, save_index *index, FILE *F);
+
 int writegame(const char *filename)
 {
     int n;
     char path[MAX_PATH];
     gamedata gdata;
+    save_index index;
     storage store;
     stream strm;
     FILE *F;
+    int level = config_get_int("game.compress", 0);
 
+#ifndef USE_ZLIB
+    if (level > 0) {
+        log_warning("game.compress is set, but zlib support is not compiled in");
+        level = 0;
+    }
+#endif
     create_directories();
     join_path(datapath(), filename, path, sizeof(path));
 #ifdef HAVE_UNISTD_H
@@ -1650,33 +1983,148 @@ int writegame(const char *filename)
         }
     }
 #endif
-    F = fopen(path, "wb");
+    F = open_datafile(path, "wb");
     if (!F) {
         perror(path);
         return -1;
     }
 
+    memset(&index, 0, sizeof(index));
     gdata.store = &store;
     gdata.version = RELEASE_VERSION;
     fwrite(&gdata.version, sizeof(int), 1, F);
-    n = STREAM_VERSION;
+    n = (level > 0) ? (STREAM_VERSION | STREAM_ZLIB) : STREAM_VERSION;
     fwrite(&n, sizeof(int), 1, F);
 
+#ifdef USE_ZLIB
+    if (level > 0) {
+        gzstream_init(&strm, F, "wb", level);
+    }
+    else
+#endif
     fstream_init(&strm, F);
     binstore_init(&store, &strm);
-
     WRITE_INT(&store, version_no(eressea_version()));
-    n = write_game(&gdata);
+    if (level > 0) {
+        /* offsets into compressed data are useless, there is no index */
+        n = write_game(&gdata);
+    }
+    else {
+        n = write_game_sections(&gdata, &index, F);
+        if (n == 0) {
+            write_save_index(F, &index);
+        }
+        free_save_index(&index);
+    }
     binstore_done(&store);
-    fstream_done(&strm);
+    if (close_datafile(&strm, F) != 0 && n == 0) {
+        n = -1;
+    }
     return n;
 }
 
-int write_game(gamedata *data) {
+#ifndef WIN32
+static pid_t g_writer_pid;
+#endif
+/* without fork, the game is written later, by writegame_wait */
+static char *g_writer_file;
+static void (*g_writer_prepare)(void);
+static int g_writer_result;
+
+#ifndef WIN32
+/* writegame changes the world a little, and the parent has to make the same
+ * changes when the child is done, so both paths end in the same state. */
+static void writegame_changes(void (*prepare)(void))
+{
+    faction *f;
+
+    if (prepare) {
+        prepare();
+    }
+    for (f = factions; f; f = f->next) {
+        if (fval(f, FFL_NPC)) {
+            clear_npc_orders(f);
+        }
+    }
+}
+#endif
+
+int writegame_async(const char *filename, void (*prepare)(void))
+{
+    if (writegame_wait() != 0) {
+        /* nobody is waiting for the previous datafile any more */
+        log_error("the previous datafile was not written");
+    }
+#ifndef WIN32
+    if (dblib_fork_begin()) {
+        pid_t pid;
+
+        /* the child must not write out buffers that the parent also holds */
+        fflush(NULL);
+        pid = fork();
+        if (pid == 0) {
+            int err;
+            dblib_fork_child();
+            if (prepare) {
+                prepare();
+            }
+            err = writegame(filename);
+            fflush(NULL);
+            /* skip atexit handlers, they belong to the parent */
+            _exit(err ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+        if (pid > 0) {
+            g_writer_pid = pid;
+            g_writer_prepare = prepare;
+            return 0;
+        }
+        log_error("could not fork to write %s: %s", filename, strerror(errno));
+    }
+#endif
+    g_writer_file = strdup(filename);
+    g_writer_prepare = prepare;
+    return 0;
+}
+
+int writegame_wait(void)
+{
+    int result;
+#ifndef WIN32
+    if (g_writer_pid > 0) {
+        int status;
+        if (waitpid(g_writer_pid, &status, 0) != g_writer_pid) {
+            log_error("waiting for datafile writer: %s", strerror(errno));
+            g_writer_result = -1;
+        }
+        else if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            log_error("datafile writer failed with status %d", status);
+            g_writer_result = -1;
+        }
+        g_writer_pid = 0;
+        writegame_changes(g_writer_prepare);
+        g_writer_prepare = NULL;
+    }
+#endif
+    if (g_writer_file) {
+        if (g_writer_prepare) {
+            g_writer_prepare();
+        }
+        g_writer_prepare = NULL;
+        g_writer_result = writegame(g_writer_file);
+        free(g_writer_file);
+        g_writer_file = NULL;
+    }
+    result = g_writer_result;
+    g_writer_result = 0;
+    return result;
+}
+
+/* if F is given, the offset of every section in F is recorded in index */
+static int write_game_sections(gamedata *data, save_index *index, FILE *F) {
     storage * store = data->store;
     region *r;
     faction *f;
-    int n;
+    int n, i;
 
     /* globale Variablen */
     assert(data->version <= MAX_VERSION && data->version >= MIN_VERSION);
@@ -1697,11 +2145,16 @@ int write_game(gamedata *data) {
     WRITE_INT(store, n);
     WRITE_SECTION(store);
 
+    if (F) {
+        index->nfactions = n;
+        index->factions = calloc(n + 1, sizeof(long long));
+    }
     log_debug(" - Schreibe %d Parteien...", n);
-    for (f = factions; f; f = f->next) {
+    for (f = factions, i = 0; f; f = f->next, ++i) {
         if (fval(f, FFL_NPC)) {
             clear_npc_orders(f);
         }
+        index_section(F, F ? index->factions + i : NULL);
         write_faction(data, f);
         WRITE_SECTION(store);
     }
@@ -1712,8 +2165,12 @@ int write_game(gamedata *data) {
     WRITE_INT(store, n);
     WRITE_SECTION(store);
     log_debug(" - Schreibe Regionen: %d", n);
+    if (F) {
+        index->nregions = n;
+        index->regions = calloc(n + 1, sizeof(save_index_region));
+    }
 
-    for (r = regions; r; r = r->next, --n) {
+    for (r = regions, i = 0; r; r = r->next, --n, ++i) {
         ship *sh;
         building *b;
         unit *u;
@@ -1722,6 +2179,12 @@ int write_game(gamedata *data) {
             log_debug(" - Schreibe Regionen: %d", n);
         }
         WRITE_SECTION(store);
+        if (F) {
+            save_index_region *ir = index->regions + i;
+            ir->x = r->x;
+            ir->y = r->y;
+            index_section(F, &ir->offset);
+        }
         write_region(data, r);
 
         WRITE_INT(store, listlen(r->buildings));
@@ -1746,8 +2209,187 @@ int write_game(gamedata *data) {
         }
     }
     WRITE_SECTION(store);
+    index_section(F, F ? &index->borders : NULL);
     write_borders(store);
     WRITE_SECTION(store);
 
     return 0;
 }
+
+int write_game(gamedata *data) {
+    return write_game_sections(data, NULL, NULL);
+}
+
+#define STATS_TERRAINS 32
+
+typedef struct terrain_stats {
+    char name[NAMESIZE];
+    int count;
+    long long bytes;
+} terrain_stats;
+
+static terrain_stats *stats_terrain(terrain_stats *terrains, int *size, const char *name)
+{
+    int i;
+    for (i = 0; i != *size; ++i) {
+        if (strcmp(terrains[i].name, name) == 0) {
+            return terrains + i;
+        }
+    }
+    if (*size == STATS_TERRAINS) {
+        return NULL;
+    }
+    ++*size;
+    strlcpy(terrains[i].name, name, sizeof(terrains[i].name));
+    terrains[i].count = 0;
+    terrains[i].bytes = 0;
+    return terrains + i;
+}
+
+static bool verify_offsets(const char *filename, const save_index *index, long long start)
+{
+    long long prev = 2 * sizeof(int);
+    int i;
+
+    for (i = 0; i != index->nfactions; ++i) {
+        if (index->factions[i] <= prev) {
+            log_error("%s: faction %d is out of order", filename, i);
+            return false;
+        }
+        prev = index->factions[i];
+    }
+    for (i = 0; i != index->nregions; ++i) {
+        if (index->regions[i].offset <= prev) {
+            log_error("%s: region %d is out of order", filename, i);
+            return false;
+        }
+        prev = index->regions[i].offset;
+    }
+    if (index->borders <= prev || index->borders > start) {
+        log_error("%s: borders are out of order", filename);
+        return false;
+    }
+    return true;
+}
+
+int verify_game(const char *filename, FILE *out)
+{
+    char path[MAX_PATH];
+    char name[NAMESIZE];
+    save_index index;
+    terrain_stats terrains[STATS_TERRAINS];
+    storage store;
+    stream strm;
+    FILE *F;
+    long long fsize, start, end, bytes, total = 0, largest = 0;
+    int i, version = 0, nterrains = 0, errors = 0, fmax = -1, rmax = -1;
+
+    if (read_save_index(filename, &index) != 0) {
+        log_error("%s has no section index", filename);
+        return -1;
+    }
+    join_path(datapath(), filename, path, sizeof(path));
+    F = fopen(path, "rb");
+    if (!F) {
+        perror(path);
+        free_save_index(&index);
+        return -1;
+    }
+    if (fread(&version, sizeof(int), 1, F) != 1 || version < MIN_VERSION || version > MAX_VERSION) {
+        log_error("%s: unsupported data version %d", filename, version);
+        ++errors;
+    }
+    fseek(F, -(long)(sizeof(long long) + sizeof(int)), SEEK_END);
+    fsize = index_tell(F) + (long long)(sizeof(long long) + sizeof(int));
+    read_index_offset(F, &start);
+    if (!verify_offsets(filename, &index, start)) {
+        fclose(F);
+        free_save_index(&index);
+        return errors + 1;
+    }
+
+    fstream_init(&strm, F);
+    binstore_init(&store, &strm);
+
+    /* the last faction block ends where the number of regions is written */
+    end = (index.nregions > 0) ? index.regions[0].offset : index.borders;
+    end -= sizeof(int);
+    for (i = index.nfactions - 1; i >= 0; --i) {
+        int no = 0;
+        bytes = end - index.factions[i];
+        end = index.factions[i];
+        index_seek(F, index.factions[i], SEEK_SET);
+        READ_INT(&store, &no);
+        if (no <= 0) {
+            log_error("%s: faction %d has invalid id %d", filename, i, no);
+            ++errors;
+        }
+        else if (bytes > largest) {
+            largest = bytes;
+            fmax = no;
+        }
+        total += bytes;
+    }
+    if (out) {
+        fprintf(out, "%s: version %d, %lld bytes\n", filename, version, fsize);
+        fprintf(out, "header: %lld bytes\n",
+            (index.nfactions > 0 ? index.factions[0] : index.borders) - (long long)(2 * sizeof(int)));
+        fprintf(out, "factions: %d, %lld bytes", index.nfactions, total);
+        if (fmax > 0) {
+            fprintf(out, ", largest %s with %lld bytes", itoa36(fmax), largest);
+        }
+        fputc('\n', out);
+    }
+
+    total = largest = 0;
+    for (i = 0; i != index.nregions; ++i) {
+        const save_index_region *ir = index.regions + i;
+        terrain_stats *ts;
+        int x = 0, y = 0, uid = 0;
+
+        end = (i + 1 < index.nregions) ? ir[1].offset : index.borders;
+        bytes = end - ir->offset;
+        total += bytes;
+        if (bytes > largest) {
+            largest = bytes;
+            rmax = i;
+        }
+        index_seek(F, ir->offset, SEEK_SET);
+        READ_INT(&store, &x);
+        READ_INT(&store, &y);
+        READ_INT(&store, &uid);
+        READ_STR(&store, name, sizeof(name));
+        if (x != ir->x || y != ir->y) {
+            log_error("%s: region %d is at (%d,%d), index says (%d,%d)", filename, i, x, y, ir->x, ir->y);
+            ++errors;
+        }
+        if (!get_terrain(name)) {
+            log_error("%s: region (%d,%d) has unknown terrain '%s'", filename, x, y, name);
+            ++errors;
+        }
+        ts = stats_terrain(terrains, &nterrains, name);
+        if (ts) {
+            ++ts->count;
+            ts->bytes += bytes;
+        }
+    }
+    if (out) {
+        fprintf(out, "regions: %d, %lld bytes", index.nregions, total);
+        if (rmax >= 0) {
+            fprintf(out, ", largest (%d,%d) with %lld bytes",
+                index.regions[rmax].x, index.regions[rmax].y, largest);
+        }
+        fputc('\n', out);
+        for (i = 0; i != nterrains; ++i) {
+            fprintf(out, "  %-16s %8d regions %12lld bytes\n", terrains[i].name,
+                terrains[i].count, terrains[i].bytes);
+        }
+        fprintf(out, "borders: %lld bytes\n", start - index.borders);
+        fprintf(out, "index: %lld bytes\n", fsize - start);
+        fprintf(out, "%d errors\n", errors);
+    }
+    binstore_done(&store);
+    fstream_done(&strm);
+    free_save_index(&index);
+    return errors;
+}
@@ -20,6 +20,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #define H_KRNL_SAVE
 
 #include <stream.h>
+#include <stdio.h>
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,6 +46,12 @@ extern "C" {
 
     int readgame(const char *filename);
     int writegame(const char *filename);
+    /* write the datafile from a forked copy of the world while the caller
+     * continues, prepare is called in the copy before writing.
+     * writegame_wait waits for the copy and returns the writegame result,
+     * the caller's world then has the changes that writegame would make. */
+    int writegame_async(const char *filename, void (*prepare)(void));
+    int writegame_wait(void);
 
     int current_turn(void);
 
@@ -66,6 +73,31 @@ extern "C" {
     int write_game(struct gamedata *data);
     int read_game(struct gamedata *data);
 
+    /* file offsets of the sections in a datafile written by writegame */
+    typedef struct save_index_region {
+        int x, y;
+        long long offset;
+    } save_index_region;
+
+    typedef struct save_index {
+        int nfactions, nregions;
+        long long *factions;
+        save_index_region *regions;
+        long long borders;
+    } save_index;
+
+    int read_save_index(const char *filename, struct save_index *index);
+    void free_save_index(struct save_index *index);
+    /* read factions and only the given regions (by position in the index).
+     * compressed datafiles have no index, read_save_index fails for them. */
+    int readgame_regions(const char *filename, const struct save_index *index, const int *regions, int nregions);
+    /* read factions and the regions with left <= x <= right, bottom <= y <= top.
+     * a datafile without an index (compressed) is read completely. */
+    int readgame_area(const char *filename, int left, int bottom, int right, int top);
+    /* check the structure of a datafile without loading it, and print the
+     * size of its sections to out (if not NULL). returns the number of errors. */
+    int verify_game(const char *filename, FILE *out);
+
     /* test-only functions that give access to internal implementation details (BAD) */
     void _test_write_password(struct gamedata *data, const struct faction *f);
     void _test_read_password(struct gamedata *data, struct faction *f);
@@ -1,15 +1,18 @@
 #include <platform.h>
 #include <kernel/config.h>
 #include <kernel/race.h>
+#include <keyword.h>
 #include <util/attrib.h>
 #include <util/gamedata.h>
 #include <attributes/key.h>
 
 #include "save.h"
+#include "database.h"
 #include "version.h"
 #include "building.h"
 #include "ship.h"
 #include "unit.h"
+#include "order.h"
 #include "group.h"
 #include "ally.h"
 #include "faction.h"
@@ -23,6 +26,7 @@
 #include <util/event.h>
 #include <util/base36.h>
 #include <util/password.h>
+#include <util/resolve.h>
 
 #include <storage.h>
 #include <memstream.h>
@@ -45,6 +49,207 @@ static void test_readwrite_data(CuTest * tc)
     test_cleanup();
 }
 
+static void rename_factions(void)
+{
+    faction *f;
+    for (f = factions; f; f = f->next) {
+        faction_setname(f, "Snapshot");
+    }
+}
+
+static void test_writegame_async(CuTest * tc)
+{
+    const char *filename = "test.dat";
+    char path[MAX_PATH];
+    faction *f;
+    int fno;
+
+    test_setup();
+    fno = test_create_faction(0)->no;
+    CuAssertIntEquals(tc, 0, writegame_async(filename, rename_factions));
+    CuAssertIntEquals(tc, 0, writegame_wait());
+    /* the caller ends up with the same changes as the datafile */
+    CuAssertStrEquals(tc, "Snapshot", findfaction(fno)->name);
+    free_gamedata();
+    CuAssertIntEquals(tc, 0, readgame(filename));
+    CuAssertPtrNotNull(tc, f = findfaction(fno));
+    CuAssertStrEquals(tc, "Snapshot", f->name);
+    CuAssertIntEquals(tc, 0, writegame_wait());
+    join_path(datapath(), filename, path, sizeof(path));
+    CuAssertIntEquals(tc, 0, remove(path));
+    test_cleanup();
+}
+
+/* compare two files in the data directory */
+static bool same_datafiles(const char *a, const char *b)
+{
+    char path[MAX_PATH];
+    FILE *Fa, *Fb;
+    int ca, cb;
+
+    Fa = fopen(join_path(datapath(), a, path, sizeof(path)), "rb");
+    Fb = fopen(join_path(datapath(), b, path, sizeof(path)), "rb");
+    do {
+        ca = Fa ? fgetc(Fa) : -2;
+        cb = Fb ? fgetc(Fb) : -3;
+    } while (ca == cb && ca != EOF);
+    if (Fa) fclose(Fa);
+    if (Fb) fclose(Fb);
+    return ca == cb;
+}
+
+static void test_writegame_async_dbfile(CuTest * tc)
+{
+    const char *dbname = "test_orders.db";
+    char path[MAX_PATH];
+    unit *u;
+
+    test_setup();
+    /* with a database file, the datafile is written by a forked child */
+    config_set("game.dbname", dbname);
+    remove(dbname);
+    dblib_close();
+    dblib_open();
+    u = test_create_unit(test_create_faction(0), test_create_region(0, 0, 0));
+    unit_addorder(u, create_order(K_WORK, u->faction->locale, NULL));
+    unit_addorder(u, create_order(K_GIVE, u->faction->locale, "abc 1 Silber"));
+    CuAssertIntEquals(tc, 0, writegame("sync.dat"));
+    CuAssertIntEquals(tc, 0, writegame_async("async.dat", NULL));
+    CuAssertIntEquals(tc, 0, writegame_wait());
+    CuAssertTrue(tc, same_datafiles("sync.dat", "async.dat"));
+    CuAssertIntEquals(tc, 0, remove(join_path(datapath(), "sync.dat", path, sizeof(path))));
+    CuAssertIntEquals(tc, 0, remove(join_path(datapath(), "async.dat", path, sizeof(path))));
+    test_cleanup();
+    dblib_close();
+    dblib_open();
+    remove(dbname);
+}
+
+static void test_save_index(CuTest * tc)
+{
+    const char *filename = "test.dat";
+    char path[MAX_PATH];
+    save_index index;
+    faction *f;
+    unit *u;
+    int fno, uno, which = 1;
+
+    test_setup();
+    f = test_create_faction(0);
+    fno = f->no;
+    test_create_unit(f, test_create_region(0, 0, 0));
+    u = test_create_unit(f, test_create_region(1, 0, 0));
+    uno = u->no;
+    CuAssertIntEquals(tc, 0, writegame(filename));
+    CuAssertIntEquals(tc, 0, read_save_index(filename, &index));
+    CuAssertIntEquals(tc, 1, index.nfactions);
+    CuAssertIntEquals(tc, 2, index.nregions);
+    CuAssertTrue(tc, index.factions[0] < index.regions[0].offset);
+    CuAssertTrue(tc, index.regions[0].offset < index.regions[1].offset);
+    CuAssertTrue(tc, index.regions[1].offset < index.borders);
+    CuAssertIntEquals(tc, 1, index.regions[1].x);
+    CuAssertIntEquals(tc, 0, index.regions[1].y);
+
+    free_gamedata();
+    CuAssertIntEquals(tc, 0, readgame_regions(filename, &index, &which, 1));
+    CuAssertIntEquals(tc, 0, ur_count());
+    CuAssertPtrNotNull(tc, findfaction(fno));
+    CuAssertPtrEquals(tc, NULL, findregion(0, 0));
+    CuAssertPtrNotNull(tc, findregion(1, 0));
+    CuAssertPtrNotNull(tc, u = findunit(uno));
+    CuAssertPtrEquals(tc, findregion(1, 0), u->region);
+    free_save_index(&index);
+
+    join_path(datapath(), filename, path, sizeof(path));
+    CuAssertIntEquals(tc, 0, remove(path));
+    test_cleanup();
+}
+
+static void test_readgame_area(CuTest * tc)
+{
+    const char *filename = "test.dat";
+    char path[MAX_PATH];
+    int fno;
+
+    test_setup();
+    fno = test_create_faction(0)->no;
+    test_create_region(0, 0, 0);
+    test_create_region(1, 0, 0);
+    test_create_region(1, 1, 0);
+    CuAssertIntEquals(tc, 0, writegame(filename));
+    free_gamedata();
+    CuAssertIntEquals(tc, 0, readgame_area(filename, 1, 0, 2, 0));
+    CuAssertPtrNotNull(tc, findfaction(fno));
+    CuAssertPtrEquals(tc, NULL, findregion(0, 0));
+    CuAssertPtrNotNull(tc, findregion(1, 0));
+    CuAssertPtrEquals(tc, NULL, findregion(1, 1));
+#ifdef USE_ZLIB
+    /* without an index, all regions are read */
+    config_set("game.compress", "1");
+    CuAssertIntEquals(tc, 0, writegame(filename));
+    free_gamedata();
+    CuAssertIntEquals(tc, 0, readgame_area(filename, 1, 0, 2, 0));
+    CuAssertPtrNotNull(tc, findregion(0, 0));
+    CuAssertPtrNotNull(tc, findregion(1, 0));
+#endif
+    join_path(datapath(), filename, path, sizeof(path));
+    CuAssertIntEquals(tc, 0, remove(path));
+    test_cleanup();
+}
+
+static void test_verify_game(CuTest * tc)
+{
+    const char *filename = "test.dat";
+    char path[MAX_PATH];
+    save_index index;
+    FILE *F;
+    int c;
+
+    test_setup();
+    test_create_unit(test_create_faction(0), test_create_region(0, 0, 0));
+    test_create_region(1, 0, 0);
+    CuAssertIntEquals(tc, 0, writegame(filename));
+    CuAssertIntEquals(tc, 0, verify_game(filename, NULL));
+
+    /* damage the x coordinate of the second region */
+    CuAssertIntEquals(tc, 0, read_save_index(filename, &index));
+    join_path(datapath(), filename, path, sizeof(path));
+    F = fopen(path, "r+b");
+    CuAssertPtrNotNull(tc, F);
+    fseek(F, index.regions[1].offset, SEEK_SET);
+    c = fgetc(F);
+    fseek(F, index.regions[1].offset, SEEK_SET);
+    fputc(c ^ 0xff, F);
+    fclose(F);
+    free_save_index(&index);
+    CuAssertIntEquals(tc, 1, verify_game(filename, NULL));
+
+    CuAssertIntEquals(tc, 0, remove(path));
+    test_cleanup();
+}
+
+#ifdef USE_ZLIB
+static void test_readwrite_compressed(CuTest * tc)
+{
+    const char *filename = "test.dat";
+    char path[MAX_PATH];
+    save_index index;
+    int fno;
+
+    test_setup();
+    fno = test_create_faction(0)->no;
+    config_set("game.compress", "1");
+    CuAssertIntEquals(tc, 0, writegame(filename));
+    CuAssertIntEquals(tc, ENOENT, read_save_index(filename, &index));
+    free_gamedata();
+    CuAssertIntEquals(tc, 0, readgame(filename));
+    CuAssertPtrNotNull(tc, findfaction(fno));
+    join_path(datapath(), filename, path, sizeof(path));
+    CuAssertIntEquals(tc, 0, remove(path));
+    test_cleanup();
+}
+#endif
+
 static void test_readwrite_unit(CuTest * tc)
 {
     gamedata data;
@@ -91,6 +296,54 @@ static void test_readwrite_unit(CuTest * tc)
     test_cleanup();
 }
 
+static void test_readwrite_orders(CuTest * tc)
+{
+    gamedata data;
+    storage store;
+    struct unit *u;
+    struct region *r;
+    struct faction *f;
+    struct order *ord;
+    char buffer[32];
+    int fno;
+
+    test_setup();
+    r = test_create_region(0, 0, 0);
+    f = test_create_faction(0);
+    fno = f->no;
+    u = test_create_unit(f, r);
+    unit_addorder(u, create_order(K_ENTERTAIN, f->locale, NULL));
+    /* its keyword is the end of the list, it is not saved */
+    unit_addorder(u, create_order_ex(K_END, CMD_PERSIST, "", f->locale));
+    unit_addorder(u, create_order_ex(K_GIVE, CMD_PERSIST, "0 1 Silber", f->locale));
+    unit_addorder(u, create_order(K_GIVE, f->locale, "0 2 Silber"));
+
+    mstream_init(&data.strm);
+    gamedata_init(&data, &store, RELEASE_VERSION);
+    write_unit(&data, u);
+
+    data.strm.api->rewind(data.strm.handle);
+    free_gamedata();
+    f = test_create_faction(0);
+    r = test_create_region(0, 0, 0);
+    renumber_faction(f, fno);
+    gamedata_init(&data, &store, RELEASE_VERSION);
+    u = read_unit(&data);
+    CuAssertPtrNotNull(tc, u);
+    CuAssertPtrNotNull(tc, ord = u->orders);
+    CuAssertIntEquals(tc, K_ENTERTAIN, getkeyword(ord));
+    CuAssertPtrNotNull(tc, ord = ord->next);
+    CuAssertIntEquals(tc, K_GIVE, getkeyword(ord));
+    CuAssertTrue(tc, is_persistent(ord));
+    CuAssertStrEquals(tc, "0 1 Silber", get_order_args(ord, f->locale, buffer, sizeof(buffer)));
+    CuAssertPtrEquals(tc, NULL, ord->next);
+
+    mstream_done(&data.strm);
+    gamedata_done(&data);
+    move_unit(u, r, NULL); /* this makes sure that u doesn't leak */
+    test_cleanup();
+}
+
 static void test_readwrite_faction(CuTest * tc)
 {
     gamedata data;
@@ -466,7 +719,16 @@ CuSuite *get_save_suite(void)
     CuSuite *suite = CuSuiteNew();
     SUITE_ADD_TEST(suite, test_readwrite_attrib);
     SUITE_ADD_TEST(suite, test_readwrite_data);
+    SUITE_ADD_TEST(suite, test_writegame_async);
+    SUITE_ADD_TEST(suite, test_writegame_async_dbfile);
+    SUITE_ADD_TEST(suite, test_save_index);
+    SUITE_ADD_TEST(suite, test_readgame_area);
+    SUITE_ADD_TEST(suite, test_verify_game);
+#ifdef USE_ZLIB
+    SUITE_ADD_TEST(suite, test_readwrite_compressed);
+#endif
     SUITE_ADD_TEST(suite, test_readwrite_unit);
+    SUITE_ADD_TEST(suite, test_readwrite_orders);
     SUITE_ADD_TEST(suite, test_readwrite_faction);
     SUITE_ADD_TEST(suite, test_readwrite_region);
     SUITE_ADD_TEST(suite, test_readwrite_building);
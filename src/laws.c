@@ -106,6 +106,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
+#include <errno.h>
 
 /* chance that a peasant dies of starvation: */
 #define PEASANT_STARVATION_CHANCE 0.9
@@ -2156,9 +2157,11 @@ int password_cmd(unit * u, struct order *ord)
     int i;
     const char *s;
     bool pwok = true;
+    parser_state ps;
 
-    init_order_depr(ord);
-    s = gettoken(pwbuf, sizeof(pwbuf));
+    init_order_ex(&ps, ord, NULL);
+    s = parser_token(&ps, pwbuf, sizeof(pwbuf));
+    parser_done(&ps);
 
     if (!s || !*s) {
         for (i = 0; i < 6; i++)
@@ -2534,11 +2537,12 @@ int group_cmd(unit * u, struct order *ord)
 int origin_cmd(unit * u, struct order *ord)
 {
     short px, py;
+    parser_state ps;
 
-    init_order_depr(ord);
-
-    px = (short)getint();
-    py = (short)getint();
+    init_order_ex(&ps, ord, NULL);
+    px = (short)parser_int(&ps);
+    py = (short)parser_int(&ps);
+    parser_done(&ps);
 
     faction_setorigin(u->faction, getplaneid(u->region), px, py);
     return 0;
@@ -2546,12 +2550,14 @@ int origin_cmd(unit * u, struct order *ord)
 
 int guard_off_cmd(unit * u, struct order *ord)
 {
-    assert(getkeyword(ord) == K_GUARD);
-    init_order_depr(ord);
+    parser_state ps;
 
-    if (getparam(u->faction->locale) == P_NOT) {
+    assert(getkeyword(ord) == K_GUARD);
+    init_order_ex(&ps, ord, NULL);
+    if (parser_param(&ps, u->faction->locale) == P_NOT) {
         setguard(u, false);
     }
+    parser_done(&ps);
     return 0;
 }
 
@@ -2560,14 +2566,16 @@ int reshow_cmd(unit * u, struct order *ord)
     char lbuf[64];
     const char *s;
     param_t p = NOPARAM;
+    parser_state ps;
 
-    init_order_depr(ord);
-    s = gettoken(lbuf, sizeof(lbuf));
+    init_order_ex(&ps, ord, NULL);
+    s = parser_token(&ps, lbuf, sizeof(lbuf));
 
     if (s && isparam(s, u->faction->locale, P_ANY)) {
-        p = getparam(u->faction->locale);
+        p = parser_param(&ps, u->faction->locale);
         s = NULL;
     }
+    parser_done(&ps);
 
     reshow(u, ord, s, p);
     return 0;
@@ -2577,9 +2585,10 @@ int status_cmd(unit * u, struct order *ord)
 {
     char token[128];
     const char *s;
+    parser_state ps;
 
-    init_order_depr(ord);
-    s = gettoken(token, sizeof(token));
+    init_order_ex(&ps, ord, NULL);
+    s = parser_token(&ps, token, sizeof(token));
     switch (findparam(s, u->faction->locale)) {
     case P_NOT:
         setstatus(u, ST_AVOID);
@@ -2600,7 +2609,7 @@ int status_cmd(unit * u, struct order *ord)
         setstatus(u, ST_FIGHT);
         break;
     case P_HELP:
-        if (getparam(u->faction->locale) == P_NOT) {
+        if (parser_param(&ps, u->faction->locale) == P_NOT) {
             fset(u, UFL_NOAID);
         }
         else {
@@ -2616,6 +2625,7 @@ int status_cmd(unit * u, struct order *ord)
             setstatus(u, ST_FIGHT);
         }
     }
+    parser_done(&ps);
     return 0;
 }
 
@@ -3657,18 +3667,19 @@ int claim_cmd(unit * u, struct order *ord)
     return 0;
 }
 
-enum {
-    PROC_THISORDER = 1 << 0,
-    PROC_LONGORDER = 1 << 1
-};
-
 typedef enum { PR_GLOBAL, PR_REGION_PRE, PR_UNIT, PR_ORDER, PR_REGION_POST } processor_t;
 
+typedef struct proc_stats {
+    double wall, cpu;
+    int calls, regions, units;
+} proc_stats;
+
 typedef struct processor {
     struct processor *next;
     int priority;
     processor_t type;
     unsigned int flags;
+    proc_stats stats;
     union {
         struct {
             keyword_t kword;
@@ -3703,7 +3714,7 @@ static processor *add_proc(int priority, const char *name, processor_t type)
         pproc = &proc->next;
     }
 
-    proc = (processor *)malloc(sizeof(processor));
+    proc = (processor *)calloc(1, sizeof(processor));
     proc->priority = priority;
     proc->type = type;
     proc->name = name;
@@ -3734,28 +3745,274 @@ void add_proc_global(int priority, void(*process) (void), const char *name)
     }
 }
 
-void add_proc_region(int priority, void(*process) (region *), const char *name)
+void add_proc_region(int priority, void(*process) (region *), unsigned int flags, const char *name)
 {
     processor *proc = add_proc(priority, name, PR_REGION_PRE);
     if (proc) {
         proc->data.per_region.process = process;
+        proc->flags = flags;
     }
 }
 
 void
-add_proc_postregion(int priority, void(*process) (region *), const char *name)
+add_proc_postregion(int priority, void(*process) (region *), unsigned int flags, const char *name)
 {
     processor *proc = add_proc(priority, name, PR_REGION_POST);
     if (proc) {
         proc->data.per_region.process = process;
+        proc->flags = flags;
     }
 }
 
-void add_proc_unit(int priority, void(*process) (unit *), const char *name)
+void add_proc_unit(int priority, void(*process) (unit *), unsigned int flags, const char *name)
 {
     processor *proc = add_proc(priority, name, PR_UNIT);
     if (proc) {
         proc->data.per_unit.process = process;
+        proc->flags = flags;
+    }
+}
+
+/* optional per-processor profile, enabled with game.profile */
+static bool profiling;
+
+typedef struct step_stats {
+    int priority;
+    proc_stats stats;
+} step_stats;
+
+typedef struct proc_timer {
+    double wall;
+    clock_t cpu;
+} proc_timer;
+
+static double wall_time(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1E9;
+#else
+    /* time() only counts seconds. with MSVC, clock() is the elapsed time
+     * in milliseconds, elsewhere it is processor time. */
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void profile_start(proc_timer *t)
+{
+    if (profiling) {
+        t->wall = wall_time();
+        t->cpu = clock();
+    }
+}
+
+static void profile_stop(proc_stats *stats, const proc_timer *t)
+{
+    if (profiling) {
+        stats->wall += wall_time() - t->wall;
+        stats->cpu += (double)(clock() - t->cpu) / CLOCKS_PER_SEC;
+        ++stats->calls;
+    }
+}
+
+static const char *proc_name(const processor *proc)
+{
+    if (proc->name) {
+        return proc->name;
+    }
+    if (proc->type == PR_ORDER) {
+        return keywords[proc->data.per_order.kword];
+    }
+    return "";
+}
+
+/* writes one line per priority step, followed by one line per processor */
+/* a step whose processors are all local could run its regions in any order */
+static bool step_is_local(const processor *proc)
+{
+    int prio = proc->priority;
+    for (; proc && proc->priority == prio; proc = proc->next) {
+        if (proc->type == PR_GLOBAL || !(proc->flags & PROC_LOCAL)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void write_profile(const char *filename, const step_stats *steps)
+{
+    FILE *F = fopen(filename, "w");
+    if (F) {
+        const processor *proc;
+        const char *types[] = { "global", "region", "unit", "order", "postregion" };
+        const step_stats *step = NULL;
+
+        fputs("turn;priority;type;name;local;calls;regions;units;wall;cpu\n", F);
+        for (proc = processors; proc; proc = proc->next) {
+            const proc_stats *stats = &proc->stats;
+            if (!step || step->priority != proc->priority) {
+                step = step ? step + 1 : steps;
+                fprintf(F, "%d;%d;step;;%d;;%d;;%f;%f\n", turn, step->priority,
+                    step_is_local(proc) ? 1 : 0, step->stats.regions,
+                    step->stats.wall, step->stats.cpu);
+            }
+            fprintf(F, "%d;%d;%s;\"%s\";%d;%d;%d;%d;%f;%f\n", turn, proc->priority,
+                types[proc->type], proc_name(proc), (proc->flags & PROC_LOCAL) ? 1 : 0,
+                stats->calls, stats->regions, stats->units, stats->wall, stats->cpu);
+        }
+        fclose(F);
+    }
+    else {
+        log_error("could not open %s: %s", filename, strerror(errno));
+    }
+}
+
+static bool can_process_long_order(region *r, unit *u, order *ord)
+{
+    if (u->number == 0) {
+        return false;
+    }
+    else if (u_race(u) == get_race(RC_INSECT)
+        && r_insectstalled(r)
+        && !is_cursed(u->attribs, &ct_insectfur)) {
+        return false;
+    }
+    else if (LongHunger(u)) {
+        cmistake(u, ord, 224, MSG_MAGIC);
+        return false;
+    }
+    else if (fval(u, UFL_LONGACTION)) {
+        /* this message was already given in laws.update_long_order
+           cmistake(u, ord, 52, MSG_PRODUCE);
+           */
+        return false;
+    }
+    else if (fval(r->terrain, SEA_REGION)
+        && u_race(u) != get_race(RC_AQUARIAN)
+        && !(u_race(u)->flags & RCF_SWIM)) {
+        /* error message disabled by popular demand */
+        return false;
+    }
+    return true;
+}
+
+/* set of the keywords in a unit's orders, so that order processors can
+ * skip units that have no orders for them */
+#define KEYWORD_SET_SIZE (NOKEYWORD / 32 + 1)
+
+typedef struct keyword_set {
+    unsigned int bits[KEYWORD_SET_SIZE];
+} keyword_set;
+
+static void keyword_set_init(keyword_set *kset, const order *ord)
+{
+    memset(kset, 0, sizeof(keyword_set));
+    for (; ord; ord = ord->next) {
+        keyword_t kwd = getkeyword(ord);
+        kset->bits[kwd / 32] |= 1U << (kwd % 32);
+    }
+}
+
+static bool keyword_set_contains(const keyword_set *kset, keyword_t kwd)
+{
+    return (kset->bits[kwd / 32] & (1U << (kwd % 32))) != 0;
+}
+
+static void process_unit(region *r, unit *u, processor *porder, int prio)
+{
+    keyword_set kset;
+    bool kset_valid = false;
+
+    while (porder && porder->priority == prio && porder->type == PR_ORDER) {
+        order **ordp = &u->orders;
+        int calls = porder->stats.calls;
+        if (porder->flags & PROC_THISORDER) {
+            ordp = &u->thisorder;
+        }
+        else {
+            /* handlers may change the unit's orders, so the set is only
+             * valid until the next one has been called */
+            if (!kset_valid) {
+                keyword_set_init(&kset, u->orders);
+                kset_valid = true;
+            }
+            if (!keyword_set_contains(&kset, porder->data.per_order.kword)) {
+                porder = porder->next;
+                continue;
+            }
+        }
+        while (*ordp) {
+            order *ord = *ordp;
+            if (getkeyword(ord) == porder->data.per_order.kword) {
+                if ((porder->flags & PROC_LONGORDER)
+                    && !can_process_long_order(r, u, ord)) {
+                    ord = NULL;
+                }
+                if (ord) {
+                    proc_timer t;
+                    profile_start(&t);
+                    porder->data.per_order.process(u, ord);
+                    profile_stop(&porder->stats, &t);
+                    kset_valid = false;
+                }
+            }
+            if (!ord || *ordp == ord)
+                ordp = &(*ordp)->next;
+        }
+        if (porder->stats.calls != calls) {
+            ++porder->stats.units;
+        }
+        porder = porder->next;
+    }
+}
+
+/* execute all processors of one priority for a single region.
+ * pregion is the first non-global processor of that priority. */
+static void process_region(region *r, processor *pregion, int prio)
+{
+    unit *u;
+    proc_timer t;
+
+    while (pregion && pregion->priority == prio
+        && pregion->type == PR_REGION_PRE) {
+        profile_start(&t);
+        pregion->data.per_region.process(r);
+        profile_stop(&pregion->stats, &t);
+        if (profiling) ++pregion->stats.regions;
+        pregion = pregion->next;
+    }
+    if (pregion == NULL || pregion->priority != prio)
+        return;
+
+    for (u = r->units; u; u = u->next) {
+        processor *punit = pregion;
+
+        while (punit && punit->priority == prio && punit->type == PR_UNIT) {
+            profile_start(&t);
+            punit->data.per_unit.process(u);
+            profile_stop(&punit->stats, &t);
+            if (profiling) ++punit->stats.units;
+            punit = punit->next;
+        }
+        if (punit == NULL || punit->priority != prio)
+            continue;
+
+        process_unit(r, u, punit, prio);
+    }
+
+    while (pregion && pregion->priority == prio
+        && pregion->type != PR_REGION_POST) {
+        pregion = pregion->next;
+    }
+
+    while (pregion && pregion->priority == prio
+        && pregion->type == PR_REGION_POST) {
+        profile_start(&t);
+        pregion->data.per_region.process(r);
+        profile_stop(&pregion->stats, &t);
+        if (profiling) ++pregion->stats.regions;
+        pregion = pregion->next;
     }
 }
 
@@ -3764,11 +4021,22 @@ void process(void)
 {
     processor *proc = processors;
     faction *f;
+    step_stats *steps = NULL;
+    int nsteps = 0;
 
+    profiling = config_get_int("game.profile", 0) != 0;
+    if (profiling) {
+        for (proc = processors; proc; proc = proc->next) {
+            memset(&proc->stats, 0, sizeof(proc_stats));
+        }
+        proc = processors;
+    }
     while (proc) {
+        int nregions = 0;
         int prio = proc->priority;
         region *r;
         processor *pglobal = proc;
+        proc_timer tstep, t;
 
         log_debug("- Step %u", prio);
         while (proc && proc->priority == prio) {
@@ -3777,98 +4045,37 @@ void process(void)
             proc = proc->next;
         }
 
+        profile_start(&tstep);
         while (pglobal && pglobal->priority == prio && pglobal->type == PR_GLOBAL) {
+            profile_start(&t);
             pglobal->data.global.process();
+            profile_stop(&pglobal->stats, &t);
             pglobal = pglobal->next;
         }
-        if (pglobal == NULL || pglobal->priority != prio)
-            continue;
-
-        for (r = regions; r; r = r->next) {
-            unit *u;
-            processor *pregion = pglobal;
-
-            while (pregion && pregion->priority == prio
-                && pregion->type == PR_REGION_PRE) {
-                pregion->data.per_region.process(r);
-                pregion = pregion->next;
-            }
-            if (pregion == NULL || pregion->priority != prio)
-                continue;
-
-            if (r->units) {
-                for (u = r->units; u; u = u->next) {
-                    processor *porder, *punit = pregion;
-
-                    while (punit && punit->priority == prio && punit->type == PR_UNIT) {
-                        punit->data.per_unit.process(u);
-                        punit = punit->next;
-                    }
-                    if (punit == NULL || punit->priority != prio)
-                        continue;
-
-                    porder = punit;
-                    while (porder && porder->priority == prio && porder->type == PR_ORDER) {
-                        order **ordp = &u->orders;
-                        if (porder->flags & PROC_THISORDER)
-                            ordp = &u->thisorder;
-                        while (*ordp) {
-                            order *ord = *ordp;
-                            if (getkeyword(ord) == porder->data.per_order.kword) {
-                                if (porder->flags & PROC_LONGORDER) {
-                                    if (u->number == 0) {
-                                        ord = NULL;
-                                    }
-                                    else if (u_race(u) == get_race(RC_INSECT)
-                                        && r_insectstalled(r)
-                                        && !is_cursed(u->attribs, &ct_insectfur)) {
-                                        ord = NULL;
-                                    }
-                                    else if (LongHunger(u)) {
-                                        cmistake(u, ord, 224, MSG_MAGIC);
-                                        ord = NULL;
-                                    }
-                                    else if (fval(u, UFL_LONGACTION)) {
-                                        /* this message was already given in laws.update_long_order
-                                           cmistake(u, ord, 52, MSG_PRODUCE);
-                                           */
-                                        ord = NULL;
-                                    }
-                                    else if (fval(r->terrain, SEA_REGION)
-                                        && u_race(u) != get_race(RC_AQUARIAN)
-                                        && !(u_race(u)->flags & RCF_SWIM)) {
-                                        /* error message disabled by popular demand */
-                                        ord = NULL;
-                                    }
-                                }
-                                if (ord) {
-                                    porder->data.per_order.process(u, ord);
-                                }
-                            }
-                            if (!ord || *ordp == ord)
-                                ordp = &(*ordp)->next;
-                        }
-                        porder = porder->next;
-                    }
-                }
+        if (pglobal && pglobal->priority == prio) {
+            for (r = regions; r; r = r->next) {
+                process_region(r, pglobal, prio);
+                ++nregions;
             }
-
-            while (pregion && pregion->priority == prio
-                && pregion->type != PR_REGION_POST) {
-                pregion = pregion->next;
-            }
-
-            while (pregion && pregion->priority == prio
-                && pregion->type == PR_REGION_POST) {
-                pregion->data.per_region.process(r);
-                pregion = pregion->next;
-            }
-            if (pregion == NULL || pregion->priority != prio)
-                continue;
-
+        }
+        if (profiling) {
+            step_stats *step;
+            steps = realloc(steps, (nsteps + 1) * sizeof(step_stats));
+            step = steps + nsteps++;
+            memset(step, 0, sizeof(step_stats));
+            step->priority = prio;
+            step->stats.regions = nregions;
+            profile_stop(&step->stats, &tstep);
         }
     }
 
+    if (profiling) {
+        char filename[MAX_PATH];
+        join_path(reportpath(), "profile.csv", filename, sizeof(filename));
+        write_profile(filename, steps);
+        free(steps);
+    }
+
     log_debug("\n - Leere Gruppen loeschen...\n");
     for (f = factions; f; f = f->next) {
         group **gp = &f->groups;
@@ -4028,22 +4235,27 @@ bool rule_force_leave(int flags) {
     return (rules&flags) == flags;
 }
 
-void init_processor(void)
+void free_processors(void)
 {
-    int p;
-
     while (processors) {
         processor * next = processors->next;
         free(processors);
         processors = next;
     }
+}
+
+void init_processor(void)
+{
+    int p;
+
+    free_processors();
 
     p = 10;
     add_proc_global(p, nmr_warnings, "NMR Warnings");
     add_proc_global(p, new_units, "Neue Einheiten erschaffen");
 
     p += 10;
-    add_proc_unit(p, update_long_order, "Langen Befehl aktualisieren");
+    add_proc_unit(p, update_long_order, PROC_LOCAL, "Langen Befehl aktualisieren");
     add_proc_order(p, K_BANNER, banner_cmd, 0, NULL);
     add_proc_order(p, K_EMAIL, email_cmd, 0, NULL);
     add_proc_order(p, K_PASSWORD, password_cmd, 0, NULL);
@@ -4056,11 +4268,11 @@ void init_processor(void)
     add_proc_order(p, K_ALLY, ally_cmd, 0, NULL);
     add_proc_order(p, K_PREFIX, prefix_cmd, 0, NULL);
     add_proc_order(p, K_SETSTEALTH, setstealth_cmd, 0, NULL);
-    add_proc_order(p, K_STATUS, status_cmd, 0, NULL);
-    add_proc_order(p, K_COMBATSPELL, combatspell_cmd, 0, NULL);
+    add_proc_order(p, K_STATUS, status_cmd, PROC_LOCAL, NULL);
+    add_proc_order(p, K_COMBATSPELL, combatspell_cmd, PROC_LOCAL, NULL);
     add_proc_order(p, K_DISPLAY, display_cmd, 0, NULL);
     add_proc_order(p, K_NAME, name_cmd, 0, NULL);
-    add_proc_order(p, K_GUARD, guard_off_cmd, 0, NULL);
+    add_proc_order(p, K_GUARD, guard_off_cmd, PROC_LOCAL, NULL);
     add_proc_order(p, K_RESHOW, reshow_cmd, 0, NULL);
 
     if (config_get_int("rules.alliances", 0) == 1) {
@@ -4069,52 +4281,52 @@ void init_processor(void)
     }
 
     p += 10;
-    add_proc_region(p, do_contact, "Kontaktieren");
+    add_proc_region(p, do_contact, PROC_LOCAL, "Kontaktieren");
     add_proc_order(p, K_MAIL, mail_cmd, 0, "Botschaften");
 
     p += 10;                      /* all claims must be done before we can USE */
-    add_proc_region(p, enter_1, "Betreten (1. Versuch)");     /* for GIVE CONTROL */
+    add_proc_region(p, enter_1, PROC_LOCAL, "Betreten (1. Versuch)");     /* for GIVE CONTROL */
     add_proc_order(p, K_USE, use_cmd, 0, "Benutzen");
 
     p += 10;                      /* in case it has any effects on alliance victories */
-    add_proc_order(p, K_GIVE, give_control_cmd, 0, "GIB KOMMANDO");
+    add_proc_order(p, K_GIVE, give_control_cmd, PROC_LOCAL, "GIB KOMMANDO");
 
     p += 10;                      /* in case it has any effects on alliance victories */
-    add_proc_order(p, K_LEAVE, leave_cmd, 0, "Verlassen");
+    add_proc_order(p, K_LEAVE, leave_cmd, PROC_LOCAL, "Verlassen");
 
     p += 10;
-    add_proc_region(p, enter_1, "Betreten (2. Versuch)"); /* to allow a buildingowner to enter the castle pre combat */
+    add_proc_region(p, enter_1, PROC_LOCAL, "Betreten (2. Versuch)"); /* to allow a buildingowner to enter the castle pre combat */
 
     p += 10;
     add_proc_global(p, do_battles, "Attackieren");
 
     if (!keyword_disabled(K_BESIEGE)) {
         p += 10;
-        add_proc_region(p, do_siege, "Belagern");
+        add_proc_region(p, do_siege, 0, "Belagern");
     }
 
     p += 10;                      /* can't allow reserve before siege (weapons) */
-    add_proc_region(p, enter_1, "Betreten (3. Versuch)");  /* to claim a castle after a victory and to be able to DESTROY it in the same turn */
+    add_proc_region(p, enter_1, PROC_LOCAL, "Betreten (3. Versuch)");  /* to claim a castle after a victory and to be able to DESTROY it in the same turn */
     if (config_get_int("rules.reserve.twophase", 0)) {
-        add_proc_order(p, K_RESERVE, reserve_self, 0, "RESERVE (self)");
+        add_proc_order(p, K_RESERVE, reserve_self, PROC_LOCAL, "RESERVE (self)");
         p += 10;
     }
-    add_proc_order(p, K_RESERVE, reserve_cmd, 0, "RESERVE (all)");
+    add_proc_order(p, K_RESERVE, reserve_cmd, PROC_LOCAL, "RESERVE (all)");
     add_proc_order(p, K_CLAIM, claim_cmd, 0, NULL);
-    add_proc_unit(p, follow_unit, "Folge auf Einheiten setzen");
+    add_proc_unit(p, follow_unit, 0, "Folge auf Einheiten setzen");
 
     p += 10;                      /* rest rng again before economics */
     if (rule_force_leave(FORCE_LEAVE_ALL)) {
-        add_proc_region(p, do_force_leave, "kick non-allies out of buildings/ships");
+        add_proc_region(p, do_force_leave, PROC_LOCAL, "kick non-allies out of buildings/ships");
     }
-    add_proc_region(p, economics, "Zerstoeren, Geben, Rekrutieren, Vergessen");
+    add_proc_region(p, economics, 0, "Zerstoeren, Geben, Rekrutieren, Vergessen");
     add_proc_order(p, K_PROMOTION, promotion_cmd, 0, "Heldenbefoerderung");
 
     p += 10;
     if (!keyword_disabled(K_PAY)) {
-        add_proc_order(p, K_PAY, pay_cmd, 0, "Gebaeudeunterhalt (BEZAHLE NICHT)");
+        add_proc_order(p, K_PAY, pay_cmd, PROC_LOCAL, "Gebaeudeunterhalt (BEZAHLE NICHT)");
     }
-    add_proc_postregion(p, maintain_buildings, "Gebaeudeunterhalt");
+    add_proc_postregion(p, maintain_buildings, 0, "Gebaeudeunterhalt");
 
     p += 10;                      /* QUIT fuer sich alleine */
     add_proc_global(p, quit, "Sterben");
@@ -4134,25 +4346,25 @@ void init_processor(void)
     p += 10;
     add_proc_order(p, K_MAKE, make_cmd, PROC_THISORDER | PROC_LONGORDER,
         "Produktion");
-    add_proc_postregion(p, produce, "Arbeiten, Handel, Rekruten");
-    add_proc_postregion(p, split_allocations, "Produktion II");
+    add_proc_postregion(p, produce, 0, "Arbeiten, Handel, Rekruten");
+    add_proc_postregion(p, split_allocations, 0, "Produktion II");
 
     p += 10;
-    add_proc_region(p, enter_2, "Betreten (4. Versuch)"); /* Once again after QUIT */
+    add_proc_region(p, enter_2, PROC_LOCAL, "Betreten (4. Versuch)"); /* Once again after QUIT */
 
     p += 10;
-    add_proc_region(p, sinkships, "Schiffe sinken");
+    add_proc_region(p, sinkships, 0, "Schiffe sinken");
 
     p += 10;
     add_proc_global(p, movement, "Bewegungen");
 
     if (config_get_int("work.auto", 0)) {
         p += 10;
-        add_proc_region(p, auto_work, "Arbeiten (auto)");
+        add_proc_region(p, auto_work, 0, "Arbeiten (auto)");
     }
 
     p += 10;
-    add_proc_order(p, K_GUARD, guard_on_cmd, 0, "Bewache (an)");
+    add_proc_order(p, K_GUARD, guard_on_cmd, PROC_LOCAL, "Bewache (an)");
 
     if (config_get_int("rules.encounters", 0)) {
         p += 10;
@@ -4160,7 +4372,7 @@ void init_processor(void)
     }
 
     p += 10;
-    add_proc_unit(p, monster_kills_peasants,
+    add_proc_unit(p, monster_kills_peasants, PROC_LOCAL,
         "Monster fressen und vertreiben Bauern");
 
     p += 10;
@@ -4283,6 +4495,154 @@ void update_subscriptions(void)
     fclose(F);
 }
 
+/* visibility table, valid while reports are written (see init_visibility).
+ * units are sorted by address, observers by faction address. */
+typedef struct vis_unit {
+    const unit *u;
+    int stealth, rings;
+} vis_unit;
+
+typedef struct vis_observer {
+    const faction *f;
+    int perception; /* best perception of this faction's units */
+    int trueseeing; /* best perception of units with an amulet of true seeing */
+} vis_observer;
+
+typedef struct region_vis {
+    int nunits, nobservers;
+    vis_unit *units;
+    vis_observer *observers;
+} region_vis;
+
+static region_vis *vis_table;
+static unsigned int vis_size;
+
+static int cmp_seen_unit(const void *a, const void *b)
+{
+    const vis_unit *sa = (const vis_unit *)a;
+    const vis_unit *sb = (const vis_unit *)b;
+    return (sa->u > sb->u) - (sa->u < sb->u);
+}
+
+static int cmp_seen_observer(const void *a, const void *b)
+{
+    const vis_observer *sa = (const vis_observer *)a;
+    const vis_observer *sb = (const vis_observer *)b;
+    return (sa->f > sb->f) - (sa->f < sb->f);
+}
+
+static void build_visibility(region_vis *vis, const region *r)
+{
+    const resource_type *rtype = get_resourcetype(R_AMULET_OF_TRUE_SEEING);
+    const unit *u;
+    int n = 0, i;
+
+    for (u = r->units; u; u = u->next) {
+        ++n;
+    }
+    vis->units = malloc(n * sizeof(vis_unit));
+    vis->observers = malloc(n * sizeof(vis_observer));
+    vis->nunits = vis->nobservers = 0;
+    for (u = r->units; u; u = u->next) {
+        vis_unit *su = vis->units + vis->nunits++;
+        su->u = u;
+        su->stealth = eff_stealth(u, r);
+        su->rings = invisible(u, NULL);
+    }
+    qsort(vis->units, vis->nunits, sizeof(vis_unit), cmp_seen_unit);
+
+    for (u = r->units; u; u = u->next) {
+        int observation = effskill(u, SK_PERCEPTION, 0);
+        vis_observer *so = NULL;
+        for (i = 0; i != vis->nobservers; ++i) {
+            if (vis->observers[i].f == u->faction) {
+                so = vis->observers + i;
+                break;
+            }
+        }
+        if (!so) {
+            so = vis->observers + vis->nobservers++;
+            so->f = u->faction;
+            so->perception = so->trueseeing = INT_MIN;
+        }
+        if (observation > so->perception) {
+            so->perception = observation;
+        }
+        if (observation > so->trueseeing && rtype && i_get(u->items, rtype->itype) > 0) {
+            so->trueseeing = observation;
+        }
+    }
+    qsort(vis->observers, vis->nobservers, sizeof(vis_observer), cmp_seen_observer);
+}
+
+/* compute stealth and invisibility of every unit, and the perception of
+ * every faction present in a region, so that cansee does not have to.
+ * the table must be freed before units change again. */
+void init_visibility(void)
+{
+    region *r;
+
+    free_visibility();
+    for (r = regions; r; r = r->next) {
+        if (r->index >= vis_size) {
+            vis_size = r->index + 1;
+        }
+    }
+    vis_table = calloc(vis_size, sizeof(region_vis));
+    for (r = regions; r; r = r->next) {
+        build_visibility(vis_table + r->index, r);
+    }
+}
+
+void free_visibility(void)
+{
+    unsigned int i;
+    for (i = 0; i != vis_size; ++i) {
+        free(vis_table[i].units);
+        free(vis_table[i].observers);
+    }
+    free(vis_table);
+    vis_table = NULL;
+    vis_size = 0;
+}
+
+static const region_vis *get_visibility(const region *r)
+{
+    if (vis_table && r->index < vis_size) {
+        return vis_table + r->index;
+    }
+    return NULL;
+}
+
+static void unit_stealth(const region_vis *vis, const unit *u, const region *r, int *stealth, int *rings)
+{
+    if (vis) {
+        vis_unit key, *su;
+        key.u = u;
+        su = (vis_unit *)bsearch(&key, vis->units, vis->nunits, sizeof(vis_unit), cmp_seen_unit);
+        if (su) {
+            *stealth = su->stealth;
+            *rings = su->rings;
+            return;
+        }
+    }
+    /* u is not in r (travel, spells), or there is no table: */
+    *stealth = eff_stealth(u, r);
+    *rings = invisible(u, NULL);
+}
+
+/* best perception of f's units in the region that are not fooled by rings */
+static int best_perception(const region_vis *vis, const faction *f, bool rings)
+{
+    vis_observer key, *so;
+    key.f = f;
+    so = (vis_observer *)bsearch(&key, vis->observers, vis->nobservers, sizeof(vis_observer), cmp_seen_observer);
+    if (!so) {
+        return INT_MIN;
+    }
+    return rings ? so->trueseeing : so->perception;
+}
+
 /** determine if unit can be seen by faction
  * @param f -- the observiong faction
  * @param u -- the unit that is observed
@@ -4296,6 +4656,7 @@ void update_subscriptions(void)
 bool
 cansee(const faction * f, const region * r, const unit * u, int modifier)
 {
+    const region_vis *vis;
     int stealth, rings;
 
     if (u->faction == f || omniscient(f)) {
@@ -4320,8 +4681,16 @@ cansee(const faction * f, const region * r, const unit * u, int modifier)
         return true;
     }
 
-    rings = invisible(u, NULL);
-    stealth = eff_stealth(u, r) - modifier;
+    vis = get_visibility(r);
+    unit_stealth(vis, u, r, &stealth, &rings);
+    stealth -= modifier;
+    if (vis) {
+        int observation = best_perception(vis, f, rings >= u->number);
+        if (observation > INT_MIN && (observation >= stealth || !skill_enabled(SK_PERCEPTION))) {
+            return true;
+        }
+        return (rings <= 0 && stealth <= 0);
+    }
 
     unit *u2;
     for (u2 = r->units; u2; u2 = u2->next) {
@@ -4365,8 +4734,8 @@ bool cansee_unit(const unit * u, const unit * target, int modifier)
             return true;
         }
 
-        n = eff_stealth(target, target->region) - modifier;
-        rings = invisible(target, NULL);
+        unit_stealth(get_visibility(target->region), target, target->region, &n, &rings);
+        n -= modifier;
         if (rings == 0 && n <= 0) {
             return true;
         }
@@ -4408,11 +4777,16 @@ cansee_durchgezogen(const faction * f, const region * r, const unit * u,
             return true;
         }
 
-        n = eff_stealth(u, r) - modifier;
-        rings = invisible(u, NULL);
+        const region_vis *vis = get_visibility(r);
+
+        unit_stealth(vis, u, r, &n, &rings);
+        n -= modifier;
         if (rings == 0 && n <= 0) {
             return true;
         }
+        if (vis) {
+            return best_perception(vis, f, rings >= u->number) >= n;
+        }
 
         for (u2 = r->units; u2; u2 = u2->next) {
             if (u2->faction == f) {
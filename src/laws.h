@@ -54,6 +54,23 @@ extern "C" {
     int enter_ship(struct unit *u, struct order *ord, int id, bool report);
 
     void processorders(void);
+    /* run the processors of a turn. with game.profile, their times
+     * are written to profile.csv in the report directory */
+    void process(void);
+
+    /* processor flags */
+    enum {
+        PROC_THISORDER = 1 << 0,
+        PROC_LONGORDER = 1 << 1,
+        /* the handler changes nothing outside of the region it is called
+         * for, and the units, buildings and ships in it. messages, the order
+         * parser and the random number generator are still shared. */
+        PROC_LOCAL = 1 << 2
+    };
+
+    void add_proc_global(int priority, void(*process) (void), const char *name);
+    void add_proc_region(int priority, void(*process) (struct region *), unsigned int flags, const char *name);
+    void free_processors(void);
     void turn_begin(void);
     void turn_process(void);
     void turn_end(void);
@@ -106,6 +123,8 @@ extern "C" {
         const struct unit *u, int modifier);
     bool cansee_unit(const struct unit *u, const struct unit *target,
         int modifier);
+    void init_visibility(void);
+    void free_visibility(void);
     bool seefaction(const struct faction *f, const struct region *r,
         const struct unit *u, int modifier);
     int armedmen(const struct unit *u, bool siege_weapons);
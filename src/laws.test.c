@@ -23,6 +23,7 @@
 #include <util/base36.h>
 #include <util/language.h>
 #include <util/message.h>
+#include <util/parser.h>
 #include <util/rand.h>
 
 #include <CuTest.h>
@@ -1477,6 +1478,90 @@ static void test_show_without_item(CuTest *tc)
     test_cleanup();
 }
 
+static int profile_globals, profile_regions;
+
+static void profile_global(void)
+{
+    ++profile_globals;
+}
+
+static void profile_region(region *r)
+{
+    ++profile_regions;
+}
+
+static void test_process_profile(CuTest *tc)
+{
+    char path[MAX_PATH], line[256];
+    FILE *F;
+
+    test_setup();
+    create_directories();
+    test_create_region(0, 0, 0);
+    test_create_region(1, 0, 0);
+    config_set("game.profile", "1");
+    free_processors();
+    add_proc_global(10, profile_global, "global");
+    add_proc_region(10, profile_region, 0, "region");
+    add_proc_region(20, profile_region, PROC_LOCAL, "local");
+    process();
+    /* the counts are for the last turn only */
+    process();
+    CuAssertIntEquals(tc, 2, profile_globals);
+    CuAssertIntEquals(tc, 8, profile_regions);
+
+    join_path(reportpath(), "profile.csv", path, sizeof(path));
+    F = fopen(path, "r");
+    CuAssertPtrNotNull(tc, F);
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertStrEquals(tc, "turn;priority;type;name;local;calls;regions;units;wall;cpu\n", line);
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertTrue(tc, strncmp(line, "1;10;step;;0;;2;;", 17) == 0);
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertTrue(tc, strncmp(line, "1;10;global;\"global\";0;1;0;0;", 29) == 0);
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertTrue(tc, strncmp(line, "1;10;region;\"region\";0;2;2;0;", 29) == 0);
+    /* a step of local processors only */
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertTrue(tc, strncmp(line, "1;20;step;;1;;2;;", 17) == 0);
+    CuAssertPtrNotNull(tc, fgets(line, sizeof(line), F));
+    CuAssertTrue(tc, strncmp(line, "1;20;region;\"local\";1;2;2;0;", 28) == 0);
+    CuAssertPtrEquals(tc, NULL, fgets(line, sizeof(line), F));
+    fclose(F);
+    CuAssertIntEquals(tc, 0, remove(path));
+    free_processors();
+    test_cleanup();
+}
+
+static void test_status_cmd(CuTest *tc)
+{
+    unit *u;
+    order *ord;
+    struct locale *loc;
+
+    test_setup();
+    loc = get_or_create_locale("de");
+    locale_setstring(loc, parameters[P_HELP], "HELFE");
+    locale_setstring(loc, parameters[P_NOT], "NICHT");
+    init_parameters(loc);
+    u = test_create_unit(test_create_faction(0), test_create_region(0, 0, 0));
+
+    /* the order has a parser of its own, and leaves the global one alone */
+    init_tokens_str("foo bar");
+    ord = create_order(K_STATUS, u->faction->locale, "HELFE NICHT");
+    status_cmd(u, ord);
+    CuAssertTrue(tc, fval(u, UFL_NOAID));
+    CuAssertStrEquals(tc, "foo", getstrtoken());
+    free_order(ord);
+
+    ord = create_order(K_STATUS, u->faction->locale, "HELFE");
+    status_cmd(u, ord);
+    CuAssertTrue(tc, !fval(u, UFL_NOAID));
+    CuAssertStrEquals(tc, "bar", getstrtoken());
+    free_order(ord);
+    test_cleanup();
+}
+
 static void test_show_race(CuTest *tc) {
     order *ord;
     race * rc;
@@ -1769,6 +1854,45 @@ static void test_cansee_sphere(CuTest *tc) {
     test_cleanup();
 }
 
+static void test_cansee_visibility(CuTest *tc) {
+    unit *u, *u2;
+    item_type *itype[2];
+
+    test_setup();
+    u = test_create_unit(test_create_faction(0), test_create_region(0, 0, 0));
+    u2 = test_create_unit(test_create_faction(0), u->region);
+    itype[0] = test_create_itemtype("roi");
+    itype[1] = test_create_itemtype("aots");
+
+    set_level(u2, SK_STEALTH, 1);
+    init_visibility();
+    CuAssertTrue(tc, !cansee(u->faction, u->region, u2, 0));
+    CuAssertTrue(tc, cansee(u->faction, u->region, u2, 1));
+    CuAssertTrue(tc, !cansee_durchgezogen(u->faction, u->region, u2, 0));
+    CuAssertTrue(tc, !cansee_unit(u, u2, 0));
+
+    /* the table is a snapshot, until it is computed again */
+    set_level(u, SK_PERCEPTION, 1);
+    CuAssertTrue(tc, !cansee(u->faction, u->region, u2, 0));
+    init_visibility();
+    CuAssertTrue(tc, cansee(u->faction, u->region, u2, 0));
+    CuAssertTrue(tc, cansee_durchgezogen(u->faction, u->region, u2, 0));
+    CuAssertTrue(tc, cansee_unit(u, u2, 0));
+
+    /* rings hide the unit, unless the observer has an amulet */
+    i_change(&u2->items, itype[0], 1);
+    init_visibility();
+    CuAssertTrue(tc, !cansee(u->faction, u->region, u2, 0));
+    CuAssertTrue(tc, !cansee_durchgezogen(u->faction, u->region, u2, 0));
+    i_change(&u->items, itype[1], 1);
+    init_visibility();
+    CuAssertTrue(tc, cansee(u->faction, u->region, u2, 0));
+    CuAssertTrue(tc, cansee_durchgezogen(u->faction, u->region, u2, 0));
+
+    free_visibility();
+    test_cleanup();
+}
+
 CuSuite *get_laws_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
@@ -1832,6 +1956,8 @@ CuSuite *get_laws_suite(void)
     SUITE_ADD_TEST(suite, test_mail_faction_no_target);
     SUITE_ADD_TEST(suite, test_luck_message);
     SUITE_ADD_TEST(suite, test_show_without_item);
+    SUITE_ADD_TEST(suite, test_status_cmd);
+    SUITE_ADD_TEST(suite, test_process_profile);
     SUITE_ADD_TEST(suite, test_show_race);
     SUITE_ADD_TEST(suite, test_show_both);
     SUITE_ADD_TEST(suite, test_immigration);
@@ -1841,6 +1967,7 @@ CuSuite *get_laws_suite(void)
     SUITE_ADD_TEST(suite, test_cansee_ring);
     SUITE_ADD_TEST(suite, test_cansee_sphere);
     SUITE_ADD_TEST(suite, test_cansee_spell);
+    SUITE_ADD_TEST(suite, test_cansee_visibility);
 
     return suite;
 }
@@ -86,6 +86,11 @@ static const char * valid_keys[] = {
     "game.sender",
     "game.dbname",
     "game.dbbatch",
+    "game.dbcache",
+    "game.profile",
+    "game.compress",
+    "game.iobuffer",
+    "game.reportworkers",
     "editor.color",
     "editor.codepage",
     "editor.population.",
@@ -68,11 +68,12 @@ static unit *unitorders(input *in, faction *f)
                 break;
 
             if (s[0]) {
-                if (s[0] != '@') {
-                    char token[64];
-                    const char *stok = s;
-                    stok = parse_token(&stok, token, sizeof(token));
+                /* as large as the buffer that parse_order uses */
+                char token[DISPLAYSIZE];
+                const char *rest = s;
+                const char *stok = parse_token(&rest, token, sizeof(token));
 
+                if (s[0] != '@') {
                     if (stok) {
                         bool quit = false;
                         param_t param = findparam(stok, u->faction->locale);
@@ -102,7 +103,8 @@ static unit *unitorders(input *in, faction *f)
                     }
                 }
                 /* Nun wird der Befehl erzeut und eingeh�ngt */
-                *ordp = parse_order(s, u->faction->locale);
+                /* the first token was parsed above, do not do it twice */
+                *ordp = parse_order_ex(stok, rest, u->faction->locale);
                 if (*ordp) {
                     ordp = &(*ordp)->next;
                 }
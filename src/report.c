@@ -748,7 +748,7 @@ rp_messages(struct stream *out, message_list * msgs, faction * viewer, int inden
                     newline(out);
                     k = 1;
                 }
-                nr_render(m->msg, viewer->locale, lbuf, sizeof(lbuf), viewer);
+                render_message(m->msg, viewer, lbuf, sizeof(lbuf));
                 paragraph(out, lbuf, indent, 2, 0);
             }
             m = m->next;
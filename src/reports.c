@@ -41,6 +41,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <kernel/connection.h>
 #include <kernel/building.h>
 #include <kernel/curse.h>
+#include <kernel/database.h>
 #include <kernel/faction.h>
 #include <kernel/group.h>
 #include <kernel/item.h>
@@ -66,6 +67,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <util/language.h>
 #include <util/lists.h>
 #include <util/log.h>
+#include <util/message.h>
+#include <util/nrmessage.h>
 #include <stream.h>
 #include <selist.h>
 
@@ -77,6 +80,11 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <stdarg.h>
 #include <stdlib.h>
 #include <time.h>
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "move.h"
 
@@ -1062,7 +1070,8 @@ void get_addresses(report_context * ctx)
         if (r->seen.mode > seen_none) break;
     }
 
-    for (; r != NULL; r = r->next) {
+    /* prepare_report put every seen region inside [first, last) */
+    for (; r != ctx->last; r = r->next) {
         int stealthmod = stealth_modifier(r, ctx->f, r->seen.mode);
         if (r->seen.mode == seen_lighthouse) {
             unit *u = r->units;
@@ -1129,6 +1138,12 @@ void register_reporttype(const char *extension, report_fun write, int flag)
     report_types = type;
 }
 
+struct report_type *_test_swap_reporttypes(struct report_type *types) {
+    report_type *old = report_types;
+    report_types = types;
+    return old;
+}
+
 void reports_done(void) {
     report_type **rtp = &report_types;
     while (*rtp) {
@@ -1215,6 +1230,16 @@ static void add_seen(region *r, seen_mode mode) {
     }
 }
 
+/* like update_interval, but seen regions do not go into f->regions */
+static void extend_interval(faction *f, region *r) {
+    if (f->first == NULL || f->first->index > r->index) {
+        f->first = r;
+    }
+    if (f->last == NULL || f->last->index <= r->index) {
+        f->last = r;
+    }
+}
+
 static void add_seen_nb(faction *f, region *r, seen_mode mode) {
     region *first = r, *last = r;
     add_seen(r, mode);
@@ -1231,8 +1256,8 @@ static void add_seen_nb(faction *f, region *r, seen_mode mode) {
             }
         }
     }
-    update_interval(f, first);
-    update_interval(f, last);
+    extend_interval(f, first);
+    extend_interval(f, last);
 }
 
 /** mark all regions seen by the lighthouse.
@@ -1396,6 +1421,55 @@ static void cb_add_seen(region *r, unit *u, void *cbdata) {
     }
 }
 
+static void password_message(faction *f)
+{
+    if (f->age <= 2) {
+        if ((f->flags&FFL_PWMSG) == 0) {
+            /* TODO: this assumes unencrypted passwords */
+            f->flags |= FFL_PWMSG;
+            ADDMSG(&f->msgs, msg_message("changepasswd", "value", f->_password));
+        }
+    }
+}
+
+/* does the faction still have units, observers, travelers or (as the
+ * region owner) a lighthouse in r? */
+static bool region_present(faction *f, region *r)
+{
+    unit *u;
+    if (fval(r, RF_TRAVELUNIT)) {
+        return true;
+    }
+    if (fval(r, RF_OBSERVER) && get_observer(r, f) >= 0) {
+        return true;
+    }
+    if (fval(r, RF_LIGHTHOUSE) && f == region_get_owner(r)) {
+        return true;
+    }
+    for (u = r->units; u; u = u->next) {
+        if (u->faction == f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* drop the regions that the faction has left from f->regions */
+static void prune_regions(faction *f)
+{
+    selist *ql, *present = NULL;
+    int qi;
+
+    for (ql = f->regions, qi = 0; ql; selist_advance(&ql, &qi, 1)) {
+        region *r = (region *)selist_get(ql, qi);
+        if (region_present(f, r)) {
+            selist_push(&present, r);
+        }
+    }
+    selist_free(f->regions);
+    f->regions = present;
+}
+
 /** set region.seen based on visibility by one faction.
  *
  * this function may also update ctx->last and ctx->first for potential
@@ -1403,7 +1477,6 @@ static void cb_add_seen(region *r, unit *u, void *cbdata) {
  */
 void prepare_report(report_context *ctx, faction *f)
 {
-    region *r;
     static int config;
     static bool rule_region_owners;
     static bool rule_lighthouse_units;
@@ -1414,24 +1487,21 @@ void prepare_report(report_context *ctx, faction *f)
         rule_lighthouse_units = config_get_int("rules.lighthouse.unit_capacity", 0) != 0;
     }
 
-    if (f->age <= 2) {
-        if ((f->flags&FFL_PWMSG) == 0) {
-            /* TODO: this assumes unencrypted passwords */
-            f->flags |= FFL_PWMSG;
-            ADDMSG(&f->msgs, msg_message("changepasswd", "value", f->_password));
-        }
-    }
+    password_message(f);
 
     ctx->f = f;
     ctx->report_time = time(NULL);
     ctx->addresses = NULL;
     ctx->userdata = NULL;
-    /* [first,last) interval of regions with a unit in it: */
     if (f->units) {
-        ctx->first = firstregion(f);
-        ctx->last = lastregion(f);
+        selist *ql;
+        int qi;
 
-        for (r = ctx->first; r != ctx->last; r = r->next) {
+        /* only the regions where the faction has units, observers or
+         * travelers */
+        prune_regions(f);
+        for (ql = f->regions, qi = 0; ql; selist_advance(&ql, &qi, 1)) {
+            region *r = (region *)selist_get(ql, qi);
             unit *u;
             building *b;
             int br = 0, c = 0, range = 0;
@@ -1602,18 +1672,102 @@ int init_reports(void)
     return 0;
 }
 
+static bool wants_reports(const faction *f)
+{
+    return f->email && !fval(f, FFL_NPC);
+}
+
+/* write the reports of every n-th faction, starting with the given one */
+static int write_reports_share(int share, int shares, time_t ltime)
+{
+    faction *f;
+    int i = 0, retval = 0;
+
+    for (f = factions; f; f = f->next) {
+        if (wants_reports(f) && (i++ % shares) == share) {
+            int error = write_reports(f, ltime);
+            if (error)
+                retval = error;
+        }
+    }
+    return retval;
+}
+
+#ifndef WIN32
+/* each worker is a forked copy of the world, with region visibility of
+ * its own, so workers cannot disturb each other's reports. this includes
+ * the render cache, which is not shared between workers. */
+static int write_reports_forked(int workers, time_t ltime)
+{
+    pid_t *pids = calloc(workers, sizeof(pid_t));
+    faction *f;
+    int w, retval = 0;
+
+    /* changes to the world that must outlive the workers: */
+    for (f = factions; f; f = f->next) {
+        if (wants_reports(f)) {
+            password_message(f);
+            prune_regions(f);
+        }
+    }
+    fflush(NULL);
+    for (w = 0; w != workers; ++w) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int err;
+            dblib_fork_child();
+            err = write_reports_share(w, workers, ltime);
+            fflush(NULL);
+            _exit(err ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+        else if (pid < 0) {
+            log_error("cannot fork report worker: %s", strerror(errno));
+            break;
+        }
+        pids[w] = pid;
+    }
+    for (; w != workers; ++w) {
+        /* the workers we could not start */
+        int error = write_reports_share(w, workers, ltime);
+        pids[w] = 0;
+        if (error)
+            retval = error;
+    }
+    for (w = 0; w != workers; ++w) {
+        int status;
+        if (pids[w] > 0) {
+            if (waitpid(pids[w], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+                log_error("report worker %d failed", w);
+                retval = -1;
+            }
+        }
+    }
+    free(pids);
+    for (f = factions; f; f = f->next) {
+        /* write_reports consumes these, but only in the worker */
+        selist_free(f->seen_factions);
+        f->seen_factions = NULL;
+    }
+    return retval;
+}
+#endif
+
 int reports(void)
 {
     faction *f;
     FILE *mailit;
     time_t ltime = time(NULL);
     int retval = 0;
+#ifndef WIN32
+    int workers = config_get_int("game.reportworkers", 1);
+#endif
     char path[4096];
     const char * rpath = reportpath();
 
     log_info("Writing reports for turn %d:", turn);
     report_donations();
     remove_empty_units();
+    init_visibility();
 
     join_path(rpath, "reports.txt", path, sizeof(path));
     mailit = fopen(path, "w");
@@ -1621,17 +1775,25 @@ int reports(void)
         log_error("%s could not be opened!\n", path);
     }
 
-    for (f = factions; f; f = f->next) {
-        if (f->email && !fval(f, FFL_NPC)) {
-            int error = write_reports(f, ltime);
-            if (error)
-                retval = error;
-            if (mailit)
+#ifndef WIN32
+    /* workers need a database connection of their own */
+    if (workers > 1 && dblib_fork_begin()) {
+        retval = write_reports_forked(workers, ltime);
+    }
+    else
+#endif
+    retval = write_reports_share(0, 1, ltime);
+
+    if (mailit) {
+        for (f = factions; f; f = f->next) {
+            if (wants_reports(f)) {
                 write_script(mailit, f);
+            }
         }
-    }
-    if (mailit)
         fclose(mailit);
+    }
+    free_visibility();
+    free_render_cache();
     return retval;
 }
 
@@ -2153,6 +2315,93 @@ static void eval_int36(struct opstack **stack, const void *userdata)
     UNUSED_ARG(userdata);
 }
 
+/* rendered text of messages that many factions receive, by message and
+ * locale. only messages that do not depend on the viewer are cached.
+ * the cache is filled while the reports are written, so with
+ * game.reportworkers each forked worker fills a copy of its own, and a
+ * shared message is rendered once per worker, not once per turn. */
+#define RENDER_MAXHASH 65521
+#define RENDER_MAXBYTES (32 << 20)
+
+typedef struct render_entry {
+    struct render_entry *next;
+    const struct message *msg;
+    const struct locale *lang;
+    char *text;
+} render_entry;
+
+static render_entry **render_cache;
+static size_t render_bytes;
+
+static bool render_shared(const struct message *msg)
+{
+    int i;
+    if (msg->refcount <= 1) {
+        return false;
+    }
+    for (i = 0; i != msg->type->nparameters; ++i) {
+        /* region names include the viewer's coordinates */
+        const char *type = msg->type->types[i]->name;
+        if (strcmp(type, "region") == 0 || strcmp(type, "regions") == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t render_message(const struct message *msg, const struct faction *f,
+    char *buffer, size_t size)
+{
+    const struct locale *lang = f->locale;
+    unsigned int key;
+    render_entry *re;
+    size_t len;
+
+    if (!render_shared(msg)) {
+        return nr_render(msg, lang, buffer, size, f);
+    }
+    key = (unsigned int)(((size_t)msg >> 4) ^ ((size_t)lang >> 4)) % RENDER_MAXHASH;
+    if (render_cache) {
+        for (re = render_cache[key]; re; re = re->next) {
+            if (re->msg == msg && re->lang == lang) {
+                return strlcpy(buffer, re->text, size);
+            }
+        }
+    }
+    len = nr_render(msg, lang, buffer, size, f);
+    if (len < size && render_bytes + len < RENDER_MAXBYTES) {
+        if (!render_cache) {
+            render_cache = calloc(RENDER_MAXHASH, sizeof(render_entry *));
+        }
+        re = malloc(sizeof(render_entry));
+        re->msg = msg;
+        re->lang = lang;
+        re->text = strdup(buffer);
+        re->next = render_cache[key];
+        render_cache[key] = re;
+        render_bytes += len;
+    }
+    return len;
+}
+
+void free_render_cache(void)
+{
+    if (render_cache) {
+        int i;
+        for (i = 0; i != RENDER_MAXHASH; ++i) {
+            while (render_cache[i]) {
+                render_entry *re = render_cache[i];
+                render_cache[i] = re->next;
+                free(re->text);
+                free(re);
+            }
+        }
+        free(render_cache);
+        render_cache = NULL;
+    }
+    render_bytes = 0;
+}
+
 /*** END MESSAGE RENDERING ***/
 
 int stream_printf(struct stream * out, const char *format, ...)
@@ -2164,12 +2413,23 @@ int stream_printf(struct stream * out, const char *format, ...)
     /* TODO: should be in storage/stream.c (doesn't exist yet) */
     va_start(args, format);
     result = vsnprintf(buffer, bytes, format, args);
-    if (result >= 0 && (size_t)result < bytes) {
-        bytes = (size_t)result;
-        /* TODO: else = buffer too small */
-    }
-    out->api->write(out->handle, buffer, bytes);
     va_end(args);
+    if (result < 0) {
+        return result;
+    }
+    bytes = (size_t)result;
+    if (bytes < sizeof(buffer)) {
+        out->api->write(out->handle, buffer, bytes);
+    }
+    else {
+        /* long descriptions do not fit the buffer */
+        char *str = malloc(bytes + 1);
+        va_start(args, format);
+        vsnprintf(str, bytes + 1, format, args);
+        va_end(args);
+        out->api->write(out->handle, str, bytes);
+        free(str);
+    }
     return result;
 }
 
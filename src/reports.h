@@ -31,6 +31,7 @@ extern "C" {
 
     struct selist;
     struct stream;
+    struct report_type;
     struct seen_region;
 
     /* Alter, ab dem der Score angezeigt werden soll: */
@@ -88,6 +89,8 @@ extern "C" {
         const char *charset);
     void register_reporttype(const char *extension, report_fun write,
         int flag);
+    /* test-only: replace the registered report types, returns the old ones */
+    struct report_type *_test_swap_reporttypes(struct report_type *types);
 
     int bufunit(const struct faction *f, const struct unit *u, unsigned int indent,
         seen_mode mode, char *buf, size_t size);
@@ -131,6 +134,11 @@ extern "C" {
     void split_paragraph(struct strlist ** SP, const char *s, unsigned int indent, unsigned int width, char mark);
 
     int stream_printf(struct stream * out, const char *format, ...);
+    /* nr_render for f, from a cache of messages that many factions share.
+     * the cache is valid while reports are written, see free_render_cache */
+    size_t render_message(const struct message *msg, const struct faction *f,
+        char *buffer, size_t size);
+    void free_render_cache(void);
 
     int count_travelthru(struct region *r, const struct faction *f);
     const char *get_mailcmd(const struct locale *loc);
@@ -13,6 +13,7 @@
 #include <kernel/building.h>
 #include <kernel/faction.h>
 #include <kernel/item.h>
+#include <kernel/messages.h>
 #include <kernel/race.h>
 #include <kernel/region.h>
 #include <kernel/ship.h>
@@ -23,9 +24,11 @@
 #include <kernel/terrain.h>
 
 #include <util/attrib.h>
+#include <util/base36.h>
 #include <util/language.h>
 #include <util/lists.h>
 #include <util/message.h>
+#include <util/nrmessage.h>
 
 #include <attributes/attributes.h>
 #include <attributes/key.h>
@@ -38,6 +41,7 @@
 #include <CuTest.h>
 #include <tests.h>
 
+#include <stdio.h>
 #include <string.h>
 
 static void test_reorder_units(CuTest * tc)
@@ -346,6 +350,79 @@ static void test_newbie_password_message(CuTest *tc) {
     test_cleanup();
 }
 
+static int write_test_report(const char *filename, report_context *ctx, const char *charset) {
+    FILE *F = fopen(filename, "w");
+    if (!F) {
+        return -1;
+    }
+    fprintf(F, "%s %d\n", itoa36(ctx->f->no), ctx->f->flags & FFL_PWMSG);
+    fclose(F);
+    return 0;
+}
+
+static void read_test_report(CuTest *tc, const faction *f, char *buf, size_t size) {
+    char filename[32], path[MAX_PATH];
+    FILE *F;
+
+    sprintf(filename, "%d-%s.test", turn, itoa36(f->no));
+    join_path(reportpath(), filename, path, sizeof(path));
+    F = fopen(path, "r");
+    CuAssertPtrNotNull(tc, F);
+    CuAssertPtrNotNull(tc, fgets(buf, (int)size, F));
+    fclose(F);
+    CuAssertIntEquals(tc, 0, remove(path));
+}
+
+static void test_report_workers(CuTest *tc) {
+    faction *f[3];
+    char serial[3][64], forked[64], path[MAX_PATH];
+    struct report_type *types;
+    region *r;
+    unit *u;
+    int i;
+
+    test_setup();
+    types = _test_swap_reporttypes(NULL);
+    register_reporttype("test", write_test_report, 1 << O_REPORT);
+    create_directories();
+    for (i = 0; i != 3; ++i) {
+        f[i] = test_create_faction(0);
+        f[i]->options = 1 << O_REPORT;
+        f[i]->age = 5;
+    }
+    CuAssertIntEquals(tc, 0, reports());
+    for (i = 0; i != 3; ++i) {
+        read_test_report(tc, f[i], serial[i], sizeof(serial[i]));
+    }
+
+    config_set("game.reportworkers", "2");
+    f[1]->age = 1;
+    f[1]->flags = 0;
+    add_seen_faction(f[0], f[2]);
+    u = test_create_unit(f[0], test_create_region(0, 0, 0));
+    r = test_create_region(1, 0, 0);
+    move_unit(u, r, NULL);
+    CuAssertIntEquals(tc, 2, selist_length(f[0]->regions));
+    CuAssertIntEquals(tc, 0, reports());
+    for (i = 0; i != 3; ++i) {
+        read_test_report(tc, f[i], forked, sizeof(forked));
+        if (i != 1) {
+            CuAssertStrEquals(tc, serial[i], forked);
+        }
+    }
+    /* changes that the workers make must also happen in the parent */
+    CuAssertIntEquals(tc, FFL_PWMSG, f[1]->flags & FFL_PWMSG);
+    CuAssertPtrEquals(tc, NULL, f[0]->seen_factions);
+    CuAssertIntEquals(tc, 1, selist_length(f[0]->regions));
+    CuAssertPtrEquals(tc, r, selist_get(f[0]->regions, 0));
+
+    join_path(reportpath(), "reports.txt", path, sizeof(path));
+    remove(path);
+    reports_done();
+    _test_swap_reporttypes(types);
+    test_cleanup();
+}
+
 static void test_prepare_travelthru(CuTest *tc) {
     report_context ctx;
     faction *f, *f2;
@@ -637,6 +714,32 @@ static void test_prepare_report(CuTest *tc) {
     test_cleanup();
 }
 
+static void test_prepare_report_regions(CuTest *tc) {
+    report_context ctx;
+    faction *f;
+    region *r1, *r2, *r3;
+    unit *u;
+
+    test_setup();
+    f = test_create_faction(0);
+    r1 = test_create_region(0, 0, 0);
+    r2 = test_create_region(5, 0, 0);
+    r3 = test_create_region(9, 0, 0);
+    test_create_unit(test_create_faction(0), r2);
+    u = test_create_unit(f, r3);
+    test_create_unit(f, r1);
+    CuAssertIntEquals(tc, 2, selist_length(f->regions));
+    CuAssertPtrEquals(tc, r1, selist_get(f->regions, 0));
+    CuAssertPtrEquals(tc, r3, selist_get(f->regions, 1));
+
+    move_unit(u, r1, NULL);
+    prepare_report(&ctx, f);
+    finish_reports(&ctx);
+    CuAssertIntEquals(tc, 1, selist_length(f->regions));
+    CuAssertPtrEquals(tc, r1, selist_get(f->regions, 0));
+    test_cleanup();
+}
+
 static void test_seen_neighbours(CuTest *tc) {
     report_context ctx;
     faction *f;
@@ -780,6 +883,71 @@ static void test_stealth_modifier(CuTest *tc) {
     test_cleanup();
 }
 
+static void test_stream_printf_long(CuTest *tc) {
+    stream strm;
+    char str[5000], line[8192];
+
+    memset(str, 'x', sizeof(str) - 1);
+    str[sizeof(str) - 1] = 0;
+    mstream_init(&strm);
+    CuAssertIntEquals(tc, (int)sizeof(str) + 1, stream_printf(&strm, "\"%s\"", str));
+    swrite("\n", 1, 1, &strm);
+    strm.api->rewind(strm.handle);
+    CuAssertIntEquals(tc, 0, strm.api->readln(strm.handle, line, sizeof(line)));
+    CuAssertIntEquals(tc, (int)sizeof(str) + 1, (int)strlen(line));
+    CuAssertIntEquals(tc, '"', line[sizeof(str)]);
+    mstream_done(&strm);
+}
+
+static void test_render_message_cache(CuTest *tc) {
+    faction *f1, *f2;
+    region *r1, *r2;
+    message *msg;
+    char buf[64], name[64];
+
+    test_setup();
+    f1 = test_create_faction(0);
+    f2 = test_create_faction(0);
+    r1 = test_create_region(0, 0, 0);
+    r2 = test_create_region(1, 0, 0);
+    mt_register(mt_new_va("test_shared", "number:int", 0));
+    mt_register(mt_new_va("test_region", "region:region", 0));
+    nrt_register(mt_find("test_shared"), f1->locale, "$int($number) peasants", 0, "events");
+    nrt_register(mt_find("test_region"), f1->locale, "$region($region)", 0, "events");
+
+    msg = msg_message("test_shared", "number", 42);
+    CuAssertIntEquals(tc, 11, (int)render_message(msg, f1, buf, sizeof(buf)));
+    CuAssertStrEquals(tc, "42 peasants", buf);
+    /* messages that only one faction receives are not cached */
+    msg->parameters[0].i = 7;
+    render_message(msg, f1, buf, sizeof(buf));
+    CuAssertStrEquals(tc, "7 peasants", buf);
+
+    add_message(&f1->msgs, msg);
+    add_message(&f2->msgs, msg);
+    render_message(msg, f1, buf, sizeof(buf));
+    msg->parameters[0].i = 8;
+    render_message(msg, f2, buf, sizeof(buf));
+    CuAssertStrEquals(tc, "7 peasants", buf);
+    free_render_cache();
+    render_message(msg, f2, buf, sizeof(buf));
+    CuAssertStrEquals(tc, "8 peasants", buf);
+    msg_release(msg);
+
+    /* region names depend on the viewer, and are never cached */
+    msg = msg_message("test_region", "region", r1);
+    add_message(&f1->msgs, msg);
+    add_message(&f2->msgs, msg);
+    render_message(msg, f1, name, sizeof(name));
+    msg->parameters[0].v = r2;
+    render_message(msg, f2, buf, sizeof(buf));
+    CuAssertTrue(tc, strcmp(name, buf) != 0);
+    msg_release(msg);
+    free_render_cache();
+    free_nrmesssages();
+    test_cleanup();
+}
+
 CuSuite *get_reports_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
@@ -788,6 +956,8 @@ CuSuite *get_reports_suite(void)
     SUITE_ADD_TEST(suite, test_region_distance_ql);
     SUITE_ADD_TEST(suite, test_newbie_password_message);
     SUITE_ADD_TEST(suite, test_prepare_report);
+    SUITE_ADD_TEST(suite, test_prepare_report_regions);
+    SUITE_ADD_TEST(suite, test_report_workers);
     SUITE_ADD_TEST(suite, test_seen_neighbours);
     SUITE_ADD_TEST(suite, test_seen_travelthru);
     SUITE_ADD_TEST(suite, test_prepare_lighthouse);
@@ -799,6 +969,8 @@ CuSuite *get_reports_suite(void)
     SUITE_ADD_TEST(suite, test_get_addresses_travelthru);
     SUITE_ADD_TEST(suite, test_report_far_vision);
     SUITE_ADD_TEST(suite, test_reorder_units);
+    SUITE_ADD_TEST(suite, test_stream_printf_long);
+    SUITE_ADD_TEST(suite, test_render_message_cache);
     SUITE_ADD_TEST(suite, test_seen_faction);
     SUITE_ADD_TEST(suite, test_stealth_modifier);
     SUITE_ADD_TEST(suite, test_regionid);
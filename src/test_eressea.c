@@ -66,6 +66,7 @@ int RunAllTests(int argc, char *argv[])
     /* self-test */
     ADD_SUITE(tests);
     ADD_SUITE(json);
+    ADD_SUITE(columns);
     ADD_SUITE(jsonconf);
     ADD_SUITE(direction);
     ADD_SUITE(skill);
@@ -88,6 +89,7 @@ int RunAllTests(int argc, char *argv[])
     ADD_SUITE(strings);
     ADD_SUITE(log);
     ADD_SUITE(variant);
+    ADD_SUITE(resolve);
     ADD_SUITE(rng);
     /* items */
     ADD_SUITE(xerewards);
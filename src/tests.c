@@ -5,6 +5,7 @@
 #include "reports.h"
 #include "calendar.h"
 #include "vortex.h"
+#include "laws.h"
 
 #include <kernel/config.h>
 #include <kernel/alliance.h>
@@ -30,6 +31,7 @@
 #include <util/message.h>
 #include <util/log.h>
 #include <util/rand.h>
+#include <util/resolve.h>
 #include <util/assert.h>
 
 #include <CuTest.h>
@@ -204,7 +206,10 @@ static void test_reset(void) {
         log_error("errno: %d (%s)", error, strerror(error));
     }
 
+    free_visibility();
+    free_render_cache();
     free_gamedata();
+    ur_reset();
     free_terrains();
     free_resources();
     free_config();
@@ -35,9 +35,12 @@ int read_attribs(gamedata *data, attrib **alist, void *owner) {
     if (data->version < ATHASH_VERSION) {
         result = a_read_orig(data, alist, owner);
     }
-    else {
+    else if (data->version < ATRUN_VERSION) {
         result = a_read(data, alist, owner);
     }
+    else {
+        result = a_read_runs(data, alist, owner);
+    }
     if (result == AT_READ_DEPR) {
         /* handle deprecated attributes */
         attrib *a = *alist;
@@ -55,8 +58,10 @@ void write_attribs(storage *store, attrib *alist, const void *owner)
 {
 #if RELEASE_VERSION < ATHASH_VERSION
     a_write_orig(store, alist, owner);
-#else
+#elif RELEASE_VERSION < ATRUN_VERSION
     a_write(store, alist, owner);
+#else
+    a_write_runs(store, alist, owner);
 #endif
 }
 
@@ -415,15 +420,15 @@ void at_deprecate(const char * name, int(*reader)(attrib *, void *, struct gamed
     cb_insert(&cb_deprecated, &value, sizeof(value));
 }
 
-static int a_read_i(gamedata *data, attrib ** attribs, void *owner, unsigned int key) {
+/* read n attributes of the type with the given key */
+static int a_read_n(gamedata *data, attrib ** attribs, void *owner, unsigned int key, int n) {
     int retval = AT_READ_OK;
     int(*reader)(attrib *, void *, struct gamedata *) = 0;
     attrib_type *at = at_find_key(key);
-    attrib * na = 0;
+    attrib *last = NULL;
 
     if (at) {
         reader = at->read;
-        na = a_new(at);
     }
     else {
         void *match;
@@ -436,13 +441,26 @@ static int a_read_i(gamedata *data, attrib ** attribs, void *owner, unsigned int
             assert(at || !"attribute not registered");
         }
     }
-    if (reader) {
+    if (!reader) {
+        assert(!"error: no registered callback can read attribute");
+        return retval;
+    }
+    while (n-- > 0) {
+        attrib *na = at ? a_new(at) : NULL;
         int ret = reader(na, owner, data);
         if (na) {
             switch (ret) {
             case AT_READ_DEPR:
             case AT_READ_OK:
-                a_add(attribs, na);
+                if (last) {
+                    /* last is the end of this type's group, same as a_add */
+                    na->next = last->next;
+                    last->next = na;
+                }
+                else {
+                    a_add(attribs, na);
+                }
+                last = na;
                 retval = ret;
                 break;
             case AT_READ_FAIL:
@@ -454,12 +472,13 @@ static int a_read_i(gamedata *data, attrib ** attribs, void *owner, unsigned int
             }
         }
     }
-    else {
-        assert(!"error: no registered callback can read attribute");
-    }
     return retval;
 }
 
+static int a_read_i(gamedata *data, attrib ** attribs, void *owner, unsigned int key) {
+    return a_read_n(data, attribs, owner, key, 1);
+}
+
 int a_read(gamedata *data, attrib ** attribs, void *owner) {
     struct storage *store = data->store;
     int key, retval = AT_READ_OK;
@@ -476,6 +495,24 @@ int a_read(gamedata *data, attrib ** attribs, void *owner) {
     return retval;
 }
 
+int a_read_runs(gamedata *data, attrib ** attribs, void *owner) {
+    struct storage *store = data->store;
+    int key, retval = AT_READ_OK;
+
+    key = -1;
+    READ_INT(store, &key);
+    while (key > 0) {
+        int n, ret;
+        READ_INT(store, &n);
+        ret = a_read_n(data, attribs, owner, key, n);
+        if (ret == AT_READ_DEPR) {
+            retval = AT_READ_DEPR;
+        }
+        READ_INT(store, &key);
+    }
+    return retval;
+}
+
 int a_read_orig(gamedata *data, attrib ** attribs, void *owner)
 {
     int key, retval = AT_READ_OK;
@@ -517,6 +554,34 @@ void a_write(struct storage *store, const attrib * attribs, const void *owner) {
     WRITE_INT(store, 0);
 }
 
+/* attributes of the same type are written as a run: the type's key,
+ * the number of attributes, then their data. */
+void a_write_runs(struct storage *store, const attrib * attribs, const void *owner) {
+    const attrib *na = attribs;
+
+    while (na) {
+        const attrib_type *at = na->type;
+        if (at->write) {
+            const attrib *a;
+            int n = 0;
+            assert(at->hashkey || !"attribute not registered");
+            for (a = na; a && a->type == at; a = a->next) {
+                ++n;
+            }
+            WRITE_INT(store, at->hashkey);
+            WRITE_INT(store, n);
+            for (a = na; n > 0; a = a->next, --n) {
+                at->write(a, owner, store);
+            }
+            na = a;
+        }
+        else {
+            na = na->nexttype;
+        }
+    }
+    WRITE_INT(store, 0);
+}
+
 void a_write_orig(struct storage *store, const attrib * attribs, const void *owner)
 {
     const attrib *na = attribs;
@@ -86,6 +86,9 @@ extern "C" {
     int a_read(struct gamedata *data, attrib ** attribs, void *owner);
     void a_write(struct storage *store, const attrib * attribs, const void *owner);
 
+    int a_read_runs(struct gamedata *data, attrib ** attribs, void *owner);
+    void a_write_runs(struct storage *store, const attrib * attribs, const void *owner);
+
     int a_readint(struct attrib *a, void *owner, struct gamedata *);
     void a_writeint(const struct attrib *a, const void *owner,
         struct storage *store);
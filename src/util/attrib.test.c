@@ -194,6 +194,46 @@ static void test_attrib_rwshorts(CuTest *tc) {
     test_cleanup();
 }
 
+static attrib_type at_runfoo = {
+    "runfoo", NULL, NULL, NULL, a_writeint, a_readint
+};
+static attrib_type at_runbar = {
+    "runbar", NULL, NULL, NULL, a_writeint, a_readint
+};
+
+static void test_attrib_rwruns(CuTest *tc) {
+    gamedata data;
+    storage store;
+    attrib *a, *alist = NULL;
+    int i;
+
+    test_setup();
+    at_register(&at_runfoo);
+    at_register(&at_runbar);
+    for (i = 0; i != 3; ++i) {
+        a_add(&alist, a_new(&at_runfoo))->data.i = i;
+    }
+    a_add(&alist, a_new(&at_runbar))->data.i = 42;
+    mstream_init(&data.strm);
+    gamedata_init(&data, &store, RELEASE_VERSION);
+    a_write_runs(&store, alist, NULL);
+    a_removeall(&alist, NULL);
+    data.strm.api->rewind(data.strm.handle);
+    CuAssertIntEquals(tc, AT_READ_OK, a_read_runs(&data, &alist, NULL));
+    for (a = alist, i = 0; i != 3; ++i, a = a->next) {
+        CuAssertPtrEquals(tc, &at_runfoo, (void *)a->type);
+        CuAssertIntEquals(tc, i, a->data.i);
+    }
+    CuAssertPtrEquals(tc, a, alist->nexttype);
+    CuAssertPtrEquals(tc, &at_runbar, (void *)a->type);
+    CuAssertIntEquals(tc, 42, a->data.i);
+    CuAssertPtrEquals(tc, NULL, a->next);
+    a_removeall(&alist, NULL);
+    mstream_done(&data.strm);
+    gamedata_done(&data);
+    test_cleanup();
+}
+
 CuSuite *get_attrib_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
@@ -207,5 +247,6 @@ CuSuite *get_attrib_suite(void)
     SUITE_ADD_TEST(suite, test_attrib_rwint);
     SUITE_ADD_TEST(suite, test_attrib_rwchars);
     SUITE_ADD_TEST(suite, test_attrib_rwshorts);
+    SUITE_ADD_TEST(suite, test_attrib_rwruns);
     return suite;
 }
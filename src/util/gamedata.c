@@ -1,6 +1,7 @@
 ﻿#include <platform.h>
 
 #include "gamedata.h"
+#include "gzstream.h"
 #include "log.h"
 
 #include <storage.h>
@@ -26,17 +27,23 @@ void gamedata_init(gamedata *data, storage *store, int version) {
 int gamedata_openfile(gamedata *data, const char *filename, const char *mode, int version) {
     FILE *F = fopen(filename, mode);
     if (F) {
-        int err = 0;
+        int err = 0, stream_version = STREAM_VERSION;
 
         if (strchr(mode, 'r')) {
             size_t sz;
             sz = fread(&version, 1, sizeof(int), F);
+            if (sz == sizeof(int)) {
+                sz = fread(&stream_version, 1, sizeof(int), F);
+            }
             if (sz != sizeof(int)) {
                 err = ferror(F);
             }
-            else {
-                err = fseek(F, sizeof(int), SEEK_CUR);
+#ifndef USE_ZLIB
+            else if (stream_version & STREAM_ZLIB) {
+                log_error("%s is compressed, but zlib support is not compiled in", filename);
+                err = EINVAL;
             }
+#endif
         }
         else if (strchr(mode, 'w')) {
             int n = STREAM_VERSION;
@@ -49,6 +56,12 @@ int gamedata_openfile(gamedata *data, const char *filename, const char *mode, in
         }
         else {
             storage *store = malloc(sizeof(storage));
+#ifdef USE_ZLIB
+            if (stream_version & STREAM_ZLIB) {
+                gzstream_init(&data->strm, F, mode, 0);
+            }
+            else
+#endif
             fstream_init(&data->strm, F);
             gamedata_init(data, store, version);
         }
@@ -66,8 +79,16 @@ gamedata *gamedata_open(const char *filename, const char *mode, int version) {
     return data;
 }
 
-void gamedata_close(gamedata *data) {
+int gamedata_close(gamedata *data) {
+    int err = 0;
     gamedata_done(data);
+#ifdef USE_ZLIB
+    if (gzstream_check(&data->strm)) {
+        err = gzstream_done(&data->strm);
+    }
+    else
+#endif
     fstream_done(&data->strm);
     free(data->store);
+    return err;
 }
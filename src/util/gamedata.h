@@ -36,14 +36,17 @@
 #define FAMILIAR_FIX_VERSION 359 /* familiar links are fixed */
 #define SKILLSORT_VERSION 360 /* u->skills is sorted */
 #define LANDDISPLAY_VERSION 360 /* r.display is now in r.land.display */
+#define ORDERDATA_VERSION 361 /* orders are stored as keyword, flags and arguments */
+#define ATRUN_VERSION 362 /* attributes of the same type are stored as a run */
 /* unfinished: */
 #define CRYPT_VERSION 400 /* passwords are encrypted */
 
-#define RELEASE_VERSION LANDDISPLAY_VERSION /* current datafile */
+#define RELEASE_VERSION ATRUN_VERSION /* current datafile */
 #define MIN_VERSION UIDHASH_VERSION      /* minimal datafile we support */
 #define MAX_VERSION RELEASE_VERSION /* change this if we can need to read the future datafile, and we can do so */
 
 #define STREAM_VERSION 2 /* internal encoding of binary files */
+#define STREAM_ZLIB 0x100 /* flag in the stream version: the data after the header is deflated */
 
 struct storage;
 
@@ -56,7 +59,8 @@ typedef struct gamedata {
 void gamedata_init(gamedata *data, struct storage *store, int version);
 void gamedata_done(gamedata *data);
 
-void gamedata_close(gamedata *data);
+/* returns -1 if writing a compressed file failed */
+int gamedata_close(gamedata *data);
 gamedata *gamedata_open(const char *filename, const char *mode, int version);
 int gamedata_openfile(gamedata *data, const char *filename, const char *mode, int version);
 
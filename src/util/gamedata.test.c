@@ -1,6 +1,10 @@
 #include <platform.h>
 #include "gamedata.h"
+#include "gzstream.h"
 
+#include <storage.h>
+#include <stream.h>
+#include <binarystore.h>
 #include <CuTest.h>
 #include <tests.h>
 #include <stdio.h>
@@ -19,9 +23,45 @@ static void test_gamedata(CuTest * tc)
     CuAssertIntEquals(tc, 0, remove("test.dat"));
 }
 
+#ifdef USE_ZLIB
+static void test_gamedata_compressed(CuTest * tc)
+{
+    gamedata *data;
+    storage store;
+    stream strm;
+    FILE *F;
+    int n;
+
+    F = fopen("test.dat", "wb");
+    n = RELEASE_VERSION;
+    fwrite(&n, sizeof(int), 1, F);
+    n = STREAM_VERSION | STREAM_ZLIB;
+    fwrite(&n, sizeof(int), 1, F);
+    gzstream_init(&strm, F, "wb", 1);
+    CuAssertTrue(tc, gzstream_check(&strm));
+    binstore_init(&store, &strm);
+    WRITE_INT(&store, 42);
+    binstore_done(&store);
+    CuAssertIntEquals(tc, 0, gzstream_done(&strm));
+
+    data = gamedata_open("test.dat", "rb", 0);
+    CuAssertPtrNotNull(tc, data);
+    CuAssertIntEquals(tc, RELEASE_VERSION, data->version);
+    CuAssertTrue(tc, gzstream_check(&data->strm));
+    READ_INT(data->store, &n);
+    CuAssertIntEquals(tc, 42, n);
+    gamedata_close(data);
+    free(data);
+    CuAssertIntEquals(tc, 0, remove("test.dat"));
+}
+#endif
+
 CuSuite *get_gamedata_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
     SUITE_ADD_TEST(suite, test_gamedata);
+#ifdef USE_ZLIB
+    SUITE_ADD_TEST(suite, test_gamedata_compressed);
+#endif
     return suite;
 }
@@ -0,0 +1,189 @@
+#include <platform.h>
+
+#include "gzstream.h"
+#include "log.h"
+
+#include <stream.h>
+#include <zlib.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GZ_BUFSIZE 0x10000
+
+typedef struct gzstream {
+    FILE *F;
+    z_stream z;
+    bool writing, eof;
+    bool error; /* a write failed, the file is incomplete */
+    long start;
+    unsigned char buf[GZ_BUFSIZE];
+} gzstream;
+
+static void gz_flush(gzstream *gz)
+{
+    size_t len = GZ_BUFSIZE - gz->z.avail_out;
+    if (len > 0 && fwrite(gz->buf, 1, len, gz->F) != len && !gz->error) {
+        log_error("gzstream: write failed: %s", strerror(errno));
+        gz->error = true;
+    }
+    gz->z.next_out = gz->buf;
+    gz->z.avail_out = GZ_BUFSIZE;
+}
+
+static size_t gz_write(HSTREAM s, const void *out, size_t outlen)
+{
+    gzstream *gz = (gzstream *)s;
+
+    assert(gz->writing);
+    gz->z.next_in = (Bytef *)out;
+    gz->z.avail_in = (uInt)outlen;
+    do {
+        if (deflate(&gz->z, Z_NO_FLUSH) == Z_STREAM_ERROR) {
+            log_error("gzstream: deflate failed: %s", gz->z.msg);
+            gz->error = true;
+            return 0;
+        }
+        if (gz->z.avail_out == 0) {
+            gz_flush(gz);
+        }
+    } while (gz->z.avail_in > 0);
+    return gz->error ? 0 : outlen;
+}
+
+static size_t gz_read(HSTREAM s, void *out, size_t outlen)
+{
+    gzstream *gz = (gzstream *)s;
+
+    assert(!gz->writing);
+    gz->z.next_out = (Bytef *)out;
+    gz->z.avail_out = (uInt)outlen;
+    while (gz->z.avail_out > 0 && !gz->eof) {
+        int err;
+        if (gz->z.avail_in == 0) {
+            size_t len = fread(gz->buf, 1, GZ_BUFSIZE, gz->F);
+            if (len == 0) {
+                break;
+            }
+            gz->z.next_in = gz->buf;
+            gz->z.avail_in = (uInt)len;
+        }
+        err = inflate(&gz->z, Z_NO_FLUSH);
+        if (err == Z_STREAM_END) {
+            gz->eof = true;
+        }
+        else if (err != Z_OK) {
+            log_error("gzstream: inflate failed: %s", gz->z.msg);
+            break;
+        }
+    }
+    return outlen - gz->z.avail_out;
+}
+
+static int gz_writeln(HSTREAM s, const char *out)
+{
+    size_t len = strlen(out);
+    if (gz_write(s, out, len) != len || gz_write(s, "\n", 1) != 1) {
+        return EOF;
+    }
+    return 0;
+}
+
+static int gz_readln(HSTREAM s, char *out, size_t outlen)
+{
+    size_t len = 0;
+    char c;
+
+    while (gz_read(s, &c, 1) == 1) {
+        if (c == '\n') {
+            break;
+        }
+        if (len + 1 < outlen) {
+            out[len] = c;
+        }
+        ++len;
+    }
+    if (outlen > 0) {
+        out[(len < outlen) ? len : outlen - 1] = '\0';
+    }
+    return (len == 0 && ((gzstream *)s)->eof) ? EOF : 0;
+}
+
+static void gz_rewind(HSTREAM s)
+{
+    gzstream *gz = (gzstream *)s;
+
+    if (gz->writing) {
+        log_error("gzstream: cannot rewind a compressing stream");
+        return;
+    }
+    inflateReset(&gz->z);
+    gz->z.avail_in = 0;
+    gz->eof = false;
+    fseek(gz->F, gz->start, SEEK_SET);
+}
+
+static const stream_interface gz_api = {
+    gz_writeln, gz_readln, gz_write, gz_read, gz_rewind
+};
+
+void gzstream_init(stream *strm, FILE *F, const char *mode, int level)
+{
+    gzstream *gz = calloc(1, sizeof(gzstream));
+    int err;
+
+    gz->F = F;
+    gz->start = ftell(F);
+    gz->writing = strchr(mode, 'w') != NULL;
+    if (gz->writing) {
+        err = deflateInit(&gz->z, level);
+        gz->z.next_out = gz->buf;
+        gz->z.avail_out = GZ_BUFSIZE;
+    }
+    else {
+        err = inflateInit(&gz->z);
+    }
+    if (err != Z_OK) {
+        log_error("gzstream: cannot initialize zlib: %d", err);
+    }
+    strm->api = &gz_api;
+    strm->handle = gz;
+}
+
+int gzstream_done(stream *strm)
+{
+    gzstream *gz = (gzstream *)strm->handle;
+    bool error;
+
+    if (gz->writing) {
+        int err;
+        gz->z.avail_in = 0;
+        do {
+            err = deflate(&gz->z, Z_FINISH);
+            gz_flush(gz);
+        } while (err == Z_OK);
+        if (err != Z_STREAM_END) {
+            log_error("gzstream: deflate failed: %s", gz->z.msg);
+            gz->error = true;
+        }
+        deflateEnd(&gz->z);
+    }
+    else {
+        inflateEnd(&gz->z);
+    }
+    if (fclose(gz->F) != 0 && gz->writing && !gz->error) {
+        log_error("gzstream: close failed: %s", strerror(errno));
+        gz->error = true;
+    }
+    error = gz->error;
+    free(gz);
+    strm->handle = NULL;
+    return error ? -1 : 0;
+}
+
+bool gzstream_check(const stream *strm)
+{
+    return strm->api == &gz_api;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+
+struct stream;
+
+/* a stream that deflates everything written to F, or inflates
+ * everything read from it, starting at the current position of F.
+ * mode is "rb" or "wb", level is the zlib compression level. */
+void gzstream_init(struct stream *strm, FILE *F, const char *mode, int level);
+/* finishes the compressed data and closes F. returns 0, or -1 if
+ * writing the file failed. */
+int gzstream_done(struct stream *strm);
+bool gzstream_check(const struct stream *strm);
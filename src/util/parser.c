@@ -6,6 +6,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wctype.h>
 #include <memory.h>
 
@@ -13,13 +14,7 @@
 #define ESCAPE_CHAR       '\\'
 #define MAXTOKENSIZE      8192
 
-typedef struct parser_state {
-    const char *current_token;
-    struct parser_state *next;
-    void *data;
-    void(*dtor)(void *);
-} parser_state;
-
+/* the global parser, used by init_tokens_str, getstrtoken, etc. */
 static parser_state *states;
 
 static int eatwhitespace_c(const char **str_p)
@@ -52,6 +47,35 @@ static int eatwhitespace_c(const char **str_p)
     return ret;
 }
 
+void parser_init(parser_state *ps, const char *initstr, void *data, void(*dtor)(void *))
+{
+    ps->next = NULL;
+    ps->dtor = dtor;
+    ps->data = data;
+    ps->current_token = initstr;
+    ps->tokens = NULL;
+    ps->ntokens = 0;
+}
+
+void parser_init_tokens(parser_state *ps, const char *tokens, int ntokens, void *data, void(*dtor)(void *))
+{
+    parser_init(ps, NULL, data, dtor);
+    ps->tokens = tokens;
+    ps->ntokens = tokens ? ntokens : 0;
+}
+
+void parser_done(parser_state *ps)
+{
+    if (ps->dtor) {
+        ps->dtor(ps->data);
+    }
+    ps->dtor = NULL;
+    ps->data = NULL;
+    ps->current_token = NULL;
+    ps->tokens = NULL;
+    ps->ntokens = 0;
+}
+
 void init_tokens_ex(const char *initstr, void *data, void (*dtor)(void *))
 {
     if (states == NULL) {
@@ -63,6 +87,15 @@ void init_tokens_ex(const char *initstr, void *data, void (*dtor)(void *))
     states->dtor = dtor;
     states->data = data;
     states->current_token = initstr;
+    states->tokens = NULL;
+    states->ntokens = 0;
+}
+
+void init_tokens_parsed(const char *tokens, int ntokens, void *data, void(*dtor)(void *))
+{
+    init_tokens_ex(NULL, data, dtor);
+    states->tokens = tokens;
+    states->ntokens = tokens ? ntokens : 0;
 }
 
 void init_tokens_str(const char *initstr) {
@@ -87,36 +120,60 @@ void parser_popstate(void)
     states = new_state;
 }
 
-bool parser_end(void)
+bool parser_eof(parser_state *ps)
 {
-    if (states->current_token) {
-        eatwhitespace_c(&states->current_token);
-        return *states->current_token == 0;
+    if (ps->tokens) {
+        return ps->ntokens == 0;
+    }
+    if (ps->current_token) {
+        eatwhitespace_c(&ps->current_token);
+        return *ps->current_token == 0;
     }
     return true;
 }
 
-void skip_token(void)
+bool parser_end(void)
+{
+    return parser_eof(states);
+}
+
+static const char *next_token(parser_state *ps)
+{
+    const char *tok = NULL;
+    if (ps->ntokens > 0) {
+        tok = ps->tokens;
+        ps->tokens += strlen(tok) + 1;
+        --ps->ntokens;
+    }
+    return tok;
+}
+
+void parser_skip(parser_state *ps)
 {
     char quotechar = 0;
-    eatwhitespace_c(&states->current_token);
 
-    while (*states->current_token) {
+    if (ps->tokens) {
+        next_token(ps);
+        return;
+    }
+    eatwhitespace_c(&ps->current_token);
+
+    while (*ps->current_token) {
         ucs4_t ucs;
         size_t len;
 
-        unsigned char utf8_character = (unsigned char)states->current_token[0];
+        unsigned char utf8_character = (unsigned char)ps->current_token[0];
         if (~utf8_character & 0x80) {
             ucs = utf8_character;
-            ++states->current_token;
+            ++ps->current_token;
         }
         else {
-            int ret = unicode_utf8_to_ucs4(&ucs, states->current_token, &len);
+            int ret = unicode_utf8_to_ucs4(&ucs, ps->current_token, &len);
             if (ret == 0) {
-                states->current_token += len;
+                ps->current_token += len;
             }
             else {
-                log_warning("illegal character sequence in UTF8 string: %s\n", states->current_token);
+                log_warning("illegal character sequence in UTF8 string: %s\n", ps->current_token);
             }
         }
         if (iswspace((wint_t)ucs) && quotechar == 0) {
@@ -131,13 +188,18 @@ void skip_token(void)
                 quotechar = utf8_character;
                 break;
             case ESCAPE_CHAR:
-                ++states->current_token;
+                ++ps->current_token;
                 break;
             }
         }
     }
 }
 
+void skip_token(void)
+{
+    parser_skip(states);
+}
+
 char *parse_token(const char **str, char *lbuf, size_t buflen)
 {
     char *cursor = lbuf;
@@ -223,39 +285,86 @@ char *parse_token(const char **str, char *lbuf, size_t buflen)
     return lbuf;
 }
 
+/* copy a parsed token, truncated to whole characters like parse_token */
+static char *copy_token(const char *tok, char *lbuf, size_t buflen)
+{
+    char *cursor = lbuf;
+    while (*tok) {
+        size_t len = 1;
+        if (*(unsigned char *)tok & 0x80) {
+            ucs4_t ucs;
+            if (unicode_utf8_to_ucs4(&ucs, tok, &len) != 0) {
+                break;
+            }
+        }
+        if (cursor - buflen < lbuf - len) {
+            memcpy(cursor, tok, len);
+            cursor += len;
+        }
+        tok += len;
+    }
+    *cursor = '\0';
+    return lbuf;
+}
+
 static char pbuf[MAXTOKENSIZE];       /* STATIC_RESULT: used for return, not across calls */
 const char *parse_token_depr(const char **str)
 {
     return parse_token(str, pbuf, MAXTOKENSIZE);
 }
 
+const char *parser_token(parser_state *ps, char *lbuf, size_t bufsize)
+{
+    if (ps->tokens) {
+        const char *tok = next_token(ps);
+        if (!tok) {
+            if (bufsize > 0) {
+                *lbuf = 0;
+            }
+            return NULL;
+        }
+        return copy_token(tok, lbuf, bufsize);
+    }
+    return parse_token((const char **)&ps->current_token, lbuf, bufsize);
+}
+
 const char *getstrtoken(void)
 {
-    return parse_token((const char **)&states->current_token, pbuf, MAXTOKENSIZE);
+    return parser_token(states, pbuf, MAXTOKENSIZE);
 }
 
 const char *gettoken(char *lbuf, size_t bufsize)
 {
-    return parse_token((const char **)&states->current_token, lbuf, bufsize);
+    return parser_token(states, lbuf, bufsize);
 }
 
-int getint(void)
+int parser_int(parser_state *ps)
 {
     char token[16];
-    const char * s = gettoken(token, sizeof(token));
+    const char * s = parser_token(ps, token, sizeof(token));
     return s ? atoi(s) : 0;
 }
 
-unsigned int getuint(void)
+int getint(void)
+{
+    return parser_int(states);
+}
+
+unsigned int parser_uint(parser_state *ps)
 {
-    int n = getint();
+    int n = parser_int(ps);
     return (n < 0) ? 0 : n;
 }
 
-int getid(void)
+unsigned int getuint(void)
+{
+    return parser_uint(states);
+}
+
+int parser_id(parser_state *ps)
 {
     char token[8];
-    const char *str = gettoken(token, sizeof(token));
+    const char *str = parser_token(ps, token, sizeof(token));
     int i = str ? atoi36(str) : 0;
     if (i < 0) {
         return -1;
@@ -263,6 +372,11 @@ int getid(void)
     return i;
 }
 
+int getid(void)
+{
+    return parser_id(states);
+}
+
 unsigned int atoip(const char *s)
 {
     int n;
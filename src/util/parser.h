@@ -18,7 +18,32 @@
 extern "C" {
 #endif
 
+    /* explicit parser state, for code that must not share the global
+     * parser. data is passed to dtor when the state is done. */
+    typedef struct parser_state {
+        const char *current_token;
+        /* if tokens is set, current_token is not used. the parser reads
+         * ntokens NUL-separated tokens from it instead. */
+        const char *tokens;
+        int ntokens;
+        struct parser_state *next;
+        void *data;
+        void(*dtor)(void *);
+    } parser_state;
+
+    void parser_init(struct parser_state *ps, const char *initstr, void *data, void(*dtor)(void *));
+    void parser_init_tokens(struct parser_state *ps, const char *tokens, int ntokens, void *data, void(*dtor)(void *));
+    void parser_done(struct parser_state *ps);
+    bool parser_eof(struct parser_state *ps);
+    void parser_skip(struct parser_state *ps);
+    const char *parser_token(struct parser_state *ps, char *lbuf, size_t bufsize);
+    int parser_int(struct parser_state *ps);
+    unsigned int parser_uint(struct parser_state *ps);
+    int parser_id(struct parser_state *ps);
+
+    /* the global parser: */
     void init_tokens_ex(const char *initstr, void *data, void(*dtor)(void *));
+    void init_tokens_parsed(const char *tokens, int ntokens, void *data, void(*dtor)(void *));
     void init_tokens_str(const char *initstr);  /* initialize token parsing */
     void skip_token(void);
     const char *parse_token_depr(const char **str);
@@ -120,6 +120,43 @@ static void test_getstrtoken(CuTest *tc) {
     CuAssertPtrEquals(tc, NULL, (void *)getstrtoken());
 }
 
+static void test_parser_state(CuTest *tc) {
+    char token[128];
+    parser_state ps1, ps2;
+
+    init_tokens_str("HELP ONE");
+    parser_init(&ps1, "ii 666 -42 TWO THREE", NULL, NULL);
+    parser_init(&ps2, "FOUR", NULL, NULL);
+    CuAssertIntEquals(tc, 666, parser_id(&ps1));
+    CuAssertStrEquals(tc, "HELP", getstrtoken());
+    CuAssertIntEquals(tc, 666, parser_int(&ps1));
+    CuAssertIntEquals(tc, 0, parser_uint(&ps1));
+    parser_skip(&ps1);
+    CuAssertStrEquals(tc, "FOUR", parser_token(&ps2, token, sizeof(token)));
+    CuAssertTrue(tc, parser_eof(&ps2));
+    CuAssertStrEquals(tc, "THREE", parser_token(&ps1, token, sizeof(token)));
+    CuAssertTrue(tc, parser_eof(&ps1));
+    CuAssertStrEquals(tc, "ONE", getstrtoken());
+    parser_done(&ps1);
+    parser_done(&ps2);
+}
+
+static void test_parsed_tokens(CuTest *tc) {
+    char token[4];
+    const char tokens[] = "ii\0" "666\0" "HELP\0" "\0" "-42";
+
+    init_tokens_parsed(tokens, 5, NULL, NULL);
+    CuAssertIntEquals(tc, 666, getid());
+    CuAssertIntEquals(tc, 666, getint());
+    CuAssertTrue(tc, !parser_end());
+    CuAssertStrEquals(tc, "HEL", gettoken(token, sizeof(token)));
+    CuAssertStrEquals(tc, "", getstrtoken());
+    CuAssertIntEquals(tc, 0, getuint());
+    CuAssertTrue(tc, parser_end());
+    CuAssertPtrEquals(tc, NULL, (void *)getstrtoken());
+    init_tokens_str(NULL);
+}
+
 CuSuite *get_parser_suite(void)
 {
     CuSuite *suite = CuSuiteNew();
@@ -133,5 +170,7 @@ CuSuite *get_parser_suite(void)
     SUITE_ADD_TEST(suite, test_gettoken_short);
     SUITE_ADD_TEST(suite, test_getintegers);
     SUITE_ADD_TEST(suite, test_getstrtoken);
+    SUITE_ADD_TEST(suite, test_parser_state);
+    SUITE_ADD_TEST(suite, test_parsed_tokens);
     return suite;
 }
@@ -37,39 +37,76 @@ typedef struct unresolved {
     /* address to pass to the resolve-function */
 } unresolved;
 
+/* open addressing: id 0 is a free slot, -1 a slot that was resolved.
+ * the table grows and drops resolved slots when it is 3/4 full. */
 #define HASHSIZE 1024 /* must be a power of 2 */
-static unresolved ur_hash[HASHSIZE];
+static unresolved *ur_hash;
+static int ur_size, ur_used, ur_live;
 
-int ur_key(int id) {
+/* number of unresolved ids by type (the high byte of the id), so that
+ * resolve() can skip the table for objects nobody is waiting for. */
+#define MAXTYPES 128
+static int ur_pending[MAXTYPES];
+
+static int ur_type(int id) {
+    return id >> 24;
+}
+
+static int ur_key(int id) {
     int h = id ^ (id >> 16);
-    return h & (HASHSIZE - 1);
+    return h & (ur_size - 1);
+}
+
+static unresolved *ur_slot(int id) {
+    int k = ur_key(id);
+    while (ur_hash[k].id > 0) {
+        k = (k + 1) & (ur_size - 1);
+    }
+    return ur_hash + k;
+}
+
+static void ur_rehash(void) {
+    unresolved *old = ur_hash;
+    int i, size = ur_size;
+
+    ur_size = HASHSIZE;
+    while (ur_size < (ur_live + 1) * 2) {
+        ur_size *= 2;
+    }
+    ur_hash = calloc(ur_size, sizeof(unresolved));
+    ur_used = ur_live;
+    for (i = 0; i != size; ++i) {
+        if (old[i].id > 0) {
+            *ur_slot(old[i].id) = old[i];
+        }
+    }
+    free(old);
 }
 
 void ur_add(int id, void **addr, resolve_fun fun)
 {
-    int h, i;
+    int k;
 
     assert(id > 0);
+    assert(ur_type(id) < MAXTYPES);
     assert(addr);
     assert(!*addr);
-    
-    h = ur_key(id);
-    for (i = 0; i != HASHSIZE; ++i) {
-        int k = h + i;
-        if (k >= HASHSIZE) k -= HASHSIZE;
-        if (ur_hash[k].id <= 0) {
-            ur_hash[k].id = id;
-            ur_hash[k].resolve = fun;
-            selist_push(&ur_hash[k].addrs, addr);
-            return;
-        }
+
+    if ((ur_used + 1) * 4 > ur_size * 3) {
+        ur_rehash();
+    }
+    for (k = ur_key(id); ur_hash[k].id != 0; k = (k + 1) & (ur_size - 1)) {
         if (ur_hash[k].id == id && ur_hash[k].resolve == fun) {
-            ur_hash[k].resolve = fun;
             selist_push(&ur_hash[k].addrs, addr);
             return;
         }
     }
-    assert(!"hash table is full");
+    ur_hash[k].id = id;
+    ur_hash[k].resolve = fun;
+    selist_push(&ur_hash[k].addrs, addr);
+    ++ur_used;
+    ++ur_live;
+    ++ur_pending[ur_type(id)];
 }
 
 static bool addr_cb(void *data, void *more) {
@@ -80,22 +117,41 @@ static bool addr_cb(void *data, void *more) {
 
 void resolve(int id, void *data)
 {
-    int h, i;
-    h = ur_key(id);
-
-    for (i = 0; i != HASHSIZE; ++i) {
-        int k = h + i;
+    int k, t = ur_type(id);
 
-        if (k >= HASHSIZE) k -= HASHSIZE;
-        if (ur_hash[k].id == 0) break;
-        else if (ur_hash[k].id == id) {
+    if (t < 0 || t >= MAXTYPES || ur_pending[t] == 0) {
+        return;
+    }
+    for (k = ur_key(id); ur_hash[k].id != 0; k = (k + 1) & (ur_size - 1)) {
+        if (ur_hash[k].id == id) {
+            void *result = data;
             if (ur_hash[k].resolve) {
-                data = ur_hash[k].resolve(id, data);
+                result = ur_hash[k].resolve(id, data);
             }
-            selist_foreach_ex(ur_hash[k].addrs, addr_cb, data);
+            selist_foreach_ex(ur_hash[k].addrs, addr_cb, result);
             selist_free(ur_hash[k].addrs);
             ur_hash[k].addrs = NULL;
             ur_hash[k].id = -1;
+            --ur_live;
+            --ur_pending[t];
         }
     }
 }
+
+int ur_count(void)
+{
+    return ur_live;
+}
+
+void ur_reset(void)
+{
+    int i;
+
+    for (i = 0; i != ur_size; ++i) {
+        selist_free(ur_hash[i].addrs);
+    }
+    free(ur_hash);
+    ur_hash = NULL;
+    ur_size = ur_used = ur_live = 0;
+    memset(ur_pending, 0, sizeof(ur_pending));
+}
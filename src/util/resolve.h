@@ -31,6 +31,10 @@ extern "C" {
 
     void ur_add(int id, void **addr, resolve_fun fun);
     void resolve(int id, void *data);
+    /* number of ids that are still waiting to be resolved */
+    int ur_count(void);
+    /* forget all pending ids, without resolving them */
+    void ur_reset(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,88 @@
+#include <platform.h>
+#include "resolve.h"
+
+#include <CuTest.h>
+#include <tests.h>
+
+#include <stdlib.h>
+
+#define TYPE_A (1 << 24)
+#define TYPE_B (2 << 24)
+
+static void *resolve_twice(int id, void *data) {
+    return (char *)data + 1;
+}
+
+static void test_resolve(CuTest *tc) {
+    char obj[2];
+    void *a = NULL, *b = NULL, *c = NULL;
+
+    test_setup();
+    ur_add(TYPE_A | 1, &a, NULL);
+    ur_add(TYPE_A | 1, &b, NULL);
+    ur_add(TYPE_B | 1, &c, resolve_twice);
+    CuAssertIntEquals(tc, 2, ur_count());
+    resolve(TYPE_A | 2, obj);
+    resolve(TYPE_B | 2, obj);
+    CuAssertIntEquals(tc, 2, ur_count());
+    resolve(TYPE_A | 1, obj);
+    CuAssertPtrEquals(tc, obj, a);
+    CuAssertPtrEquals(tc, obj, b);
+    CuAssertPtrEquals(tc, NULL, c);
+    resolve(TYPE_B | 1, obj);
+    CuAssertPtrEquals(tc, obj + 1, c);
+    CuAssertIntEquals(tc, 0, ur_count());
+    test_cleanup();
+}
+
+static void test_resolve_many(CuTest *tc) {
+    const int n = 5000;
+    void **addrs = calloc(n, sizeof(void *));
+    char obj;
+    int i;
+
+    test_setup();
+    /* more ids than fit into the initial table, resolved out of order */
+    for (i = 0; i != n; ++i) {
+        ur_add(TYPE_A | (i + 1), addrs + i, NULL);
+    }
+    CuAssertIntEquals(tc, n, ur_count());
+    for (i = n; i > 0; i -= 2) {
+        resolve(TYPE_A | i, &obj);
+    }
+    for (i = n - 1; i > 0; i -= 2) {
+        resolve(TYPE_A | i, &obj);
+    }
+    CuAssertIntEquals(tc, 0, ur_count());
+    for (i = 0; i != n; ++i) {
+        CuAssertPtrEquals(tc, &obj, addrs[i]);
+    }
+    free(addrs);
+    test_cleanup();
+}
+
+static void test_ur_reset(CuTest *tc) {
+    void *a = NULL;
+    char obj;
+
+    test_setup();
+    ur_add(TYPE_A | 1, &a, NULL);
+    CuAssertIntEquals(tc, 1, ur_count());
+    ur_reset();
+    CuAssertIntEquals(tc, 0, ur_count());
+    resolve(TYPE_A | 1, &obj);
+    CuAssertPtrEquals(tc, NULL, a);
+    ur_add(TYPE_A | 1, &a, NULL);
+    CuAssertIntEquals(tc, 1, ur_count());
+    test_cleanup();
+    CuAssertIntEquals(tc, 0, ur_count());
+}
+
+CuSuite *get_resolve_suite(void)
+{
+    CuSuite *suite = CuSuiteNew();
+    SUITE_ADD_TEST(suite, test_resolve);
+    SUITE_ADD_TEST(suite, test_resolve_many);
+    SUITE_ADD_TEST(suite, test_ur_reset);
+    return suite;
+}